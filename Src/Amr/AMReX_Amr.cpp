@@ -113,6 +113,7 @@ namespace
     int  checkpoint_on_restart;
     bool checkpoint_files_output;
     int  compute_new_dt_on_regrid;
+    int  patch_comm_metadata;
     bool precreateDirectories;
     bool prereadFAHeaders;
     VisMF::Header::Version plot_headerversion(VisMF::Header::Version_v1);
@@ -148,6 +149,7 @@ Amr::Initialize ()
     checkpoint_on_restart    = 0;
     checkpoint_files_output  = true;
     compute_new_dt_on_regrid = 0;
+    patch_comm_metadata      = 1;
     precreateDirectories     = true;
     prereadFAHeaders         = true;
     plot_headerversion       = VisMF::Header::Version_v1;
@@ -288,6 +290,8 @@ Amr::InitAmr ()
 
     pp.query("compute_new_dt_on_regrid",compute_new_dt_on_regrid);
 
+    pp.query("patch_comm_metadata",patch_comm_metadata);
+
     pp.query("mffile_nstreams", mffile_nstreams);
     pp.query("probinit_natonce", probinit_natonce);
 
@@ -1761,6 +1765,16 @@ Amr::checkPoint ()
 
     HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
 
+    //
+    // With AsyncOut, the header is assembled in memory and written by the
+    // background thread after all processes have written their data, so
+    // that a checkpoint with a Header file is complete.
+    //
+    std::ostringstream HeaderSnapshot;
+
+    std::ostream& HeaderOut = (AsyncOut::UseAsyncOut())
+        ? static_cast<std::ostream&>(HeaderSnapshot) : HeaderFile;
+
     int old_prec = 0;
 
     if (ParallelDescriptor::IOProcessor())
@@ -1768,52 +1782,94 @@ Amr::checkPoint ()
         //
         // Only the IOProcessor() writes to the header file.
         //
-        HeaderFile.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
-	                                        std::ios::binary);
+        if ( ! AsyncOut::UseAsyncOut()) {
+            HeaderFile.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
+                                                    std::ios::binary);
 
-        if ( ! HeaderFile.good()) {
-            amrex::FileOpenFailed(HeaderFileName);
-	}
+            if ( ! HeaderFile.good()) {
+                amrex::FileOpenFailed(HeaderFileName);
+            }
+        }
 
-        old_prec = HeaderFile.precision(17);
+        old_prec = HeaderOut.precision(17);
 
-        HeaderFile << CheckPointVersion << '\n'
-                   << AMREX_SPACEDIM       << '\n'
-                   << cumtime           << '\n'
-                   << max_level         << '\n'
-                   << finest_level      << '\n';
+        HeaderOut << CheckPointVersion << '\n'
+                  << AMREX_SPACEDIM       << '\n'
+                  << cumtime           << '\n'
+                  << max_level         << '\n'
+                  << finest_level      << '\n';
         //
         // Write out problem domain.
         //
-        for (int i(0); i <= max_level; ++i) { HeaderFile << Geom(i)        << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i < max_level; ++i)  { HeaderFile << ref_ratio[i]   << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i <= max_level; ++i) { HeaderFile << dt_level[i]    << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i <= max_level; ++i) { HeaderFile << dt_min[i]      << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i <= max_level; ++i) { HeaderFile << n_cycle[i]     << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i <= max_level; ++i) { HeaderFile << level_steps[i] << ' '; }
-        HeaderFile << '\n';
-        for (int i(0); i <= max_level; ++i) { HeaderFile << level_count[i] << ' '; }
-        HeaderFile << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << Geom(i)        << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i < max_level; ++i)  { HeaderOut << ref_ratio[i]   << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << dt_level[i]    << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << dt_min[i]      << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << n_cycle[i]     << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << level_steps[i] << ' '; }
+        HeaderOut << '\n';
+        for (int i(0); i <= max_level; ++i) { HeaderOut << level_count[i] << ' '; }
+        HeaderOut << '\n';
     }
 
     for (int i = 0; i <= finest_level; ++i) {
-        amr_level[i]->checkPointPre(ckfileTemp, HeaderFile);
+        amr_level[i]->checkPointPre(ckfileTemp, HeaderOut);
     }
 
     for (int i = 0; i <= finest_level; ++i) {
-        amr_level[i]->checkPoint(ckfileTemp, HeaderFile);
+        amr_level[i]->checkPoint(ckfileTemp, HeaderOut);
     }
 
     for (int i = 0; i <= finest_level; ++i) {
-        amr_level[i]->checkPointPost(ckfileTemp, HeaderFile);
+        amr_level[i]->checkPointPost(ckfileTemp, HeaderOut);
     }
 
-    if (ParallelDescriptor::IOProcessor()) {
+    if (AsyncOut::UseAsyncOut()) {
+        std::shared_ptr<std::string> header;
+        std::shared_ptr<Vector<std::string> > FAHeaderNames;
+        if (ParallelDescriptor::IOProcessor()) {
+            HeaderOut.precision(old_prec);
+            header = std::make_shared<std::string>(HeaderSnapshot.str());
+            FAHeaderNames = std::make_shared<Vector<std::string> >(StateData::FabArrayHeaderNames());
+        }
+        // Every process calls this, so that the Header follows the data of
+        // all of them.
+        AsyncOut::SubmitAfterAll([=] ()
+        {
+            if ( ! header) return;
+
+            std::ofstream ofs(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
+                                                      std::ios::binary);
+            if ( ! ofs.good()) {
+                amrex::FileOpenFailed(HeaderFileName);
+            }
+            ofs.write(header->data(), header->size());
+            ofs.close();
+            if ( ! ofs.good()) {
+                amrex::Error("Amr::checkpoint() failed");
+            }
+
+            if (FAHeaderNames->size() > 0) {
+                std::string FAHeaderFilesName = ckfileTemp + "/FabArrayHeaders.txt";
+                std::ofstream FAHeaderFile(FAHeaderFilesName.c_str(),
+                                           std::ios::out | std::ios::trunc |
+                                           std::ios::binary);
+                if ( ! FAHeaderFile.good()) {
+                    amrex::FileOpenFailed(FAHeaderFilesName);
+                }
+                for (auto const& name : *FAHeaderNames) {
+                    FAHeaderFile << name << '\n';
+                }
+            }
+        });
+    }
+
+    if (ParallelDescriptor::IOProcessor() && ! AsyncOut::UseAsyncOut()) {
 	const Vector<std::string> &FAHeaderNames = StateData::FabArrayHeaderNames();
 	if(FAHeaderNames.size() > 0) {
           std::string FAHeaderFilesName = ckfileTemp + "/FabArrayHeaders.txt";
@@ -1830,7 +1886,7 @@ Amr::checkPoint ()
 	}
     }
 
-    if(ParallelDescriptor::IOProcessor()) {
+    if(ParallelDescriptor::IOProcessor() && ! AsyncOut::UseAsyncOut()) {
         HeaderFile.precision(old_prec);
 
         if( ! HeaderFile.good()) {
@@ -2895,6 +2951,14 @@ Amr::regrid (int  lbase,
             // NOTE: The init function may use a filPatch from the old level,
             //       which therefore needs remain in the hierarchy during the call.
             //
+            if (patch_comm_metadata) {
+                // Build the communication metadata of the new grids from
+                // those of the old grids, if only a few boxes have changed.
+                const DescriptorList& desc_lst = AmrLevel::get_desc_lst();
+                for (int typ = 0; typ < desc_lst.size(); ++typ) {
+                    a->get_new_data(typ).patchCommMetaData(amr_level[lev]->get_new_data(typ));
+                }
+            }
             a->init(*amr_level[lev]);
             amr_level[lev].reset(a);
 	    this->SetBoxArray(lev, amr_level[lev]->boxArray());
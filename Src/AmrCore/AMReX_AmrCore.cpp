@@ -3,6 +3,7 @@
 
 #include <AMReX_AmrCore.H>
 #include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef AMREX_PARTICLES
 #include <AMReX_AmrParGDB.H>
@@ -40,13 +41,14 @@ AmrCore::AmrCore (const RealBox& rb, int max_level_in,
 AmrCore::AmrCore (Geometry const& level_0_gome, AmrInfo const& amr_info)
     : AmrMesh(level_0_gome,amr_info)
 {
-#ifdef AMREX_PARTICLES
-    m_gdb.reset(new AmrParGDB(this));
-#endif
+    InitAmrCore();
 }
 
 AmrCore::~AmrCore ()
 {
+    for (auto& cost : m_costs) {
+        if (cost) MFIter::UnregisterCost(cost.get());
+    }
 }
 
 void
@@ -55,12 +57,126 @@ AmrCore::InitAmrCore ()
 #ifdef AMREX_PARTICLES
     m_gdb.reset(new AmrParGDB(this));
 #endif
+
+    ParmParse pp("amr");
+    pp.query("loadbalance_int", loadbalance_int);
+    pp.query("loadbalance_threshold", loadbalance_threshold);
+    pp.query("loadbalance_strategy", loadbalance_strategy);
+
+    if (loadbalance_strategy != "SFC" &&
+        loadbalance_strategy != "KNAPSACK" &&
+        loadbalance_strategy != "INCREMENTAL")
+    {
+        amrex::Abort("AmrCore: amr.loadbalance_strategy must be SFC, KNAPSACK or INCREMENTAL");
+    }
 }
 
 void
 AmrCore::InitFromScratch (Real time)
 {
     MakeNewGrids(time);
+    syncCosts();
+}
+
+void
+AmrCore::syncCosts ()
+{
+    if (loadbalance_int <= 0) return;
+
+    const int nlevs = finest_level+1;
+    for (int lev = nlevs; lev < static_cast<int>(m_costs.size()); ++lev) {
+        if (m_costs[lev]) MFIter::UnregisterCost(m_costs[lev].get());
+    }
+    m_costs.resize(nlevs);
+
+    for (int lev = 0; lev < nlevs; ++lev)
+    {
+        auto& cost = m_costs[lev];
+        if (cost == nullptr ||
+            cost->boxArray().getRefID() != grids[lev].getRefID() ||
+            cost->DistributionMap().getRefID() != dmap[lev].getRefID())
+        {
+            if (cost) MFIter::UnregisterCost(cost.get());
+            cost.reset(new LayoutData<Real>(grids[lev], dmap[lev]));
+            MFIter::RegisterCost(cost.get());
+        }
+    }
+}
+
+bool
+AmrCore::LoadBalance (Real time)
+{
+    if (loadbalance_int <= 0) return false;
+
+    syncCosts();
+
+    if (++m_lb_count < loadbalance_int) return false;
+    m_lb_count = 0;
+
+    bool changed = false;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        LayoutData<Real>& cost = *m_costs[lev];
+
+        Real total = 0.0;
+        for (int K : cost.IndexArray()) {
+            total += cost[K];
+        }
+        ParallelDescriptor::ReduceRealSum(total);
+
+        if (total > 0.0)
+        {
+            Real current_eff = 0.0;
+            Real proposed_eff = 0.0;
+            DistributionMapping new_dmap;
+            if (loadbalance_strategy == "KNAPSACK")
+            {
+                new_dmap = DistributionMapping::makeKnapSack(cost, current_eff, proposed_eff);
+            }
+            else if (loadbalance_strategy == "INCREMENTAL")
+            {
+                LayoutData<Real> bytes(grids[lev], dmap[lev]);
+                for (int K : bytes.IndexArray()) {
+                    bytes[K] = static_cast<Real>(grids[lev][K].numPts()*sizeof(Real));
+                }
+                new_dmap = DistributionMapping::makeIncremental(cost, bytes, current_eff, proposed_eff,
+                                                                loadbalance_threshold, -1);
+            }
+            else
+            {
+                new_dmap = DistributionMapping::makeSFC(cost, current_eff, proposed_eff);
+            }
+
+            // The efficiencies are only computed on the root process.
+            int doit = (current_eff < loadbalance_threshold && proposed_eff > current_eff);
+            ParallelDescriptor::Bcast(&doit, 1, ParallelDescriptor::IOProcessorNumber());
+
+            if (doit)
+            {
+                if (verbose > 0) {
+                    amrex::Print() << "AmrCore::LoadBalance: level " << lev
+                                   << " efficiency " << current_eff
+                                   << " -> " << proposed_eff << "\n";
+                }
+
+                const auto old_num_setdm = num_setdm;
+                RemakeLevel(lev, time, grids[lev], new_dmap);
+                if (old_num_setdm == num_setdm) {
+                    SetDistributionMap(lev, new_dmap);
+                }
+                changed = true;
+            }
+        }
+
+        for (int K : cost.IndexArray()) {
+            cost[K] = 0.0;
+        }
+    }
+
+    syncCosts();
+
+    return changed;
 }
 
 void
@@ -115,6 +231,8 @@ AmrCore::regrid (int lbase, Real time, bool)
     }
 
     finest_level = new_finest;
+
+    syncCosts();
 }
 
 
@@ -4,12 +4,27 @@
 #include <AMReX_CArena.H>
 #include <AMReX_DArena.H>
 #include <AMReX_EArena.H>
+#include <AMReX_TArena.H>
 
 #include <AMReX.H>
 #include <AMReX_Print.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Gpu.H>
+#include <AMReX_ParallelReduce.H>
+#ifdef AMREX_TINY_PROFILING
+#include <AMReX_TinyProfiler.H>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #ifdef _WIN32
 ///#include <memoryapi.h>
@@ -38,6 +53,186 @@ namespace {
     Long buddy_allocator_size = 0L;
     Long the_arena_init_size = 0L;
     bool abort_on_out_of_gpu_memory = false;
+    bool use_tarena = false;
+    Long tarena_max_size = 0L;
+    Long tarena_release_threshold = TArena::DefaultReleaseThreshold;
+    int huge_pages = 0;
+    bool arena_trace = false;
+    int arena_trace_ntags = 20;
+
+    struct TraceStats
+    {
+        Long current = 0;
+        Long high_water = 0;
+        Long nallocs = 0;
+        void add (Long nbytes) noexcept {
+            current += nbytes;
+            high_water = std::max(high_water, current);
+            ++nallocs;
+        }
+    };
+
+    struct TraceRecord
+    {
+        std::size_t nbytes;
+        int tag;
+        int arena;
+    };
+
+    // All the tracing data are protected by trace_mutex.
+    std::mutex trace_mutex;
+    std::thread::id trace_main_thread;
+    std::vector<std::string> trace_tags;
+    std::unordered_map<void*,TraceRecord> trace_records;
+    std::map<std::string,int> trace_tag_ids;
+    std::vector<std::string> trace_tag_names;
+    std::vector<TraceStats> trace_tag_stats;
+    std::vector<TraceStats> trace_arena_stats;
+    std::vector<std::string> trace_arena_names;
+    TraceStats trace_total_stats;
+
+    int trace_tag_id ()
+    {
+        std::string key = trace_tags.empty() ? std::string() : trace_tags.back();
+#ifdef AMREX_TINY_PROFILING
+        if (std::this_thread::get_id() == trace_main_thread) {
+            const std::string* timer = TinyProfiler::CurrentTimer();
+            if (timer) {
+                key = key.empty() ? *timer : key + " : " + *timer;
+            }
+        }
+#endif
+        if (key.empty()) key = "(untagged)";
+        auto r = trace_tag_ids.emplace(key, static_cast<int>(trace_tag_names.size()));
+        if (r.second) {
+            trace_tag_names.push_back(key);
+            trace_tag_stats.emplace_back();
+        }
+        return r.first->second;
+    }
+
+    //! Records the allocations of a global Arena when tracing is enabled.
+    class TraceArena
+        : public Arena
+    {
+    public:
+        TraceArena (Arena* a_arena, std::string const& name)
+            : m_arena(a_arena), m_id(static_cast<int>(trace_arena_names.size()))
+        {
+            trace_arena_names.push_back(name);
+            trace_arena_stats.emplace_back();
+        }
+
+        virtual ~TraceArena () override { delete m_arena; }
+
+        virtual void* alloc (std::size_t nbytes) override final
+        {
+            void* p = m_arena->alloc(nbytes);
+            std::lock_guard<std::mutex> lock(trace_mutex);
+            const int tag = trace_tag_id();
+            trace_records[p] = TraceRecord{nbytes, tag, m_id};
+            trace_tag_stats[tag].add(nbytes);
+            trace_arena_stats[m_id].add(nbytes);
+            trace_total_stats.add(nbytes);
+            return p;
+        }
+
+        virtual void free (void* p) override final
+        {
+            if (p == nullptr) return;
+            {
+                std::lock_guard<std::mutex> lock(trace_mutex);
+                auto it = trace_records.find(p);
+                if (it != trace_records.end()) {
+                    const Long nbytes = it->second.nbytes;
+                    trace_tag_stats[it->second.tag].current -= nbytes;
+                    trace_arena_stats[it->second.arena].current -= nbytes;
+                    trace_total_stats.current -= nbytes;
+                    trace_records.erase(it);
+                }
+            }
+            m_arena->free(p);
+        }
+
+        Arena* arena () const noexcept { return m_arena; }
+        int id () const noexcept { return m_id; }
+
+    private:
+        Arena* m_arena;
+        int m_id;
+    };
+
+    Arena* MakeTraceArena (Arena* arena, std::string const& name)
+    {
+        return arena_trace ? new TraceArena(arena, name) : arena;
+    }
+
+    Arena* UnwrapArena (Arena* arena)
+    {
+        TraceArena* p = dynamic_cast<TraceArena*>(arena);
+        return p ? p->arena() : arena;
+    }
+
+#if defined(__linux__)
+    constexpr std::size_t huge_page_size = 2*1024*1024;
+
+    void* allocate_huge_pages (std::size_t nbytes)
+    {
+        const std::size_t N = aligned_size(huge_page_size, nbytes);
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (huge_pages > 1) {
+            // This fails if the system has not reserved enough huge pages.
+            p = mmap(nullptr, N, PROT_READ|PROT_WRITE,
+                     MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (p == MAP_FAILED)
+        {
+            // Transparent huge pages need memory aligned to the huge page size.
+            const std::size_t M = N + huge_page_size;
+            char* q = static_cast<char*>(mmap(nullptr, M, PROT_READ|PROT_WRITE,
+                                              MAP_PRIVATE|MAP_ANONYMOUS, -1, 0));
+            if (q == MAP_FAILED) return nullptr;
+            char* a = reinterpret_cast<char*>(aligned_size(huge_page_size,
+                                                           reinterpret_cast<std::uintptr_t>(q)));
+            if (a > q) munmap(q, a-q);
+            if (q+M > a+N) munmap(a+N, (q+M)-(a+N));
+            p = a;
+#ifdef MADV_HUGEPAGE
+            madvise(p, N, MADV_HUGEPAGE);
+#endif
+        }
+        // The pages are not touched here, so that they are placed on the NUMA
+        // node of the thread that first writes to them.
+        return p;
+    }
+
+    void deallocate_huge_pages (void* p, std::size_t nbytes)
+    {
+        munmap(p, aligned_size(huge_page_size, nbytes));
+    }
+#endif
+
+    //! Huge pages are only used for host memory.
+    bool use_huge_pages (ArenaInfo const& info) noexcept
+    {
+#ifdef AMREX_USE_GPU
+        return huge_pages > 0 && info.use_huge_pages && info.use_cpu_memory;
+#else
+        return huge_pages > 0 && info.use_huge_pages;
+#endif
+    }
+
+    void PrintArenaUsage (Arena* arena, std::string const& name)
+    {
+        arena = UnwrapArena(arena);
+        if (CArena* p = dynamic_cast<CArena*>(arena)) {
+            p->PrintUsage(name);
+        } else if (TArena* p = dynamic_cast<TArena*>(arena)) {
+            p->PrintUsage(name);
+        }
+    }
 }
 
 const std::size_t Arena::align_size;
@@ -60,6 +255,14 @@ void*
 Arena::allocate_system (std::size_t nbytes)
 {
     void * p;
+#if defined(__linux__)
+    if (use_huge_pages(arena_info))
+    {
+        p = allocate_huge_pages(nbytes);
+        if (p && arena_info.device_use_hostalloc) AMREX_MLOCK(p, nbytes);
+    }
+    else
+#endif
 #ifdef AMREX_USE_GPU
     if (arena_info.use_cpu_memory)
     {
@@ -108,8 +311,10 @@ Arena::allocate_system (std::size_t nbytes)
         }
     }
 #else
-    p = std::malloc(nbytes);
-    if (p && arena_info.device_use_hostalloc) AMREX_MLOCK(p, nbytes);
+    {
+        p = std::malloc(nbytes);
+        if (p && arena_info.device_use_hostalloc) AMREX_MLOCK(p, nbytes);
+    }
 #endif
     if (p == nullptr) amrex::Abort("Sorry, malloc failed");
     return p;
@@ -118,6 +323,14 @@ Arena::allocate_system (std::size_t nbytes)
 void
 Arena::deallocate_system (void* p, std::size_t nbytes)
 {
+#if defined(__linux__)
+    if (use_huge_pages(arena_info))
+    {
+        if (p && arena_info.device_use_hostalloc) AMREX_MUNLOCK(p, nbytes);
+        deallocate_huge_pages(p, nbytes);
+        return;
+    }
+#endif
 #ifdef AMREX_USE_GPU
     if (arena_info.use_cpu_memory)
     {
@@ -161,6 +374,12 @@ Arena::Initialize ()
     pp.query("buddy_allocator_size", buddy_allocator_size);
     pp.query("the_arena_init_size", the_arena_init_size);
     pp.query("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
+    pp.query("use_tarena", use_tarena);
+    pp.query("tarena_max_size", tarena_max_size);
+    pp.query("tarena_release_threshold", tarena_release_threshold);
+    pp.query("huge_pages", huge_pages);
+    pp.query("arena_trace", arena_trace);
+    pp.query("arena_trace_ntags", arena_trace_ntags);
 
 #ifdef AMREX_USE_GPU
     if (use_buddy_allocator)
@@ -180,9 +399,8 @@ Arena::Initialize ()
     else
 #endif
     {
-#if defined(BL_COALESCE_FABS) || defined(AMREX_USE_GPU)
-        the_arena = new CArena(0, ArenaInfo().SetPreferred());
 #ifdef AMREX_USE_GPU
+        the_arena = new CArena(0, ArenaInfo().SetPreferred());
         if (the_arena_init_size <= 0) {
 #ifdef AMREX_USE_DPCPP
 //            the_arena_init_size = Gpu::Device::maxMemAllocSize() / 4L * 3L;
@@ -193,9 +411,23 @@ Arena::Initialize ()
         }
         void *p = the_arena->alloc(static_cast<std::size_t>(the_arena_init_size));
         the_arena->free(p);
-#endif
 #else
-        the_arena = new BArena;
+        ArenaInfo host_info;
+        if (huge_pages > 0) host_info.SetHugePages();
+        if (use_tarena) {
+            the_arena = new TArena(tarena_max_size, host_info, tarena_release_threshold);
+        } else {
+#ifdef BL_COALESCE_FABS
+            the_arena = new CArena(0, host_info);
+#else
+            // Huge pages need an Arena that allocates large hunks.
+            if (huge_pages > 0) {
+                the_arena = new CArena(0, host_info);
+            } else {
+                the_arena = new BArena;
+            }
+#endif
+        }
 #endif
     }
 
@@ -226,7 +458,141 @@ Arena::Initialize ()
     p = the_pinned_arena->alloc(N);
     the_pinned_arena->free(p);
 
-    the_cpu_arena = new BArena;
+    if (use_tarena) {
+        ArenaInfo cpu_info = ArenaInfo().SetCpuMemory();
+        if (huge_pages > 0) cpu_info.SetHugePages();
+        the_cpu_arena = new TArena(tarena_max_size, cpu_info, tarena_release_threshold);
+    } else {
+        the_cpu_arena = new BArena;
+    }
+
+    if (arena_trace)
+    {
+        trace_main_thread = std::this_thread::get_id();
+        the_arena         = MakeTraceArena(the_arena,         "The         Arena");
+        the_device_arena  = MakeTraceArena(the_device_arena,  "The  Device Arena");
+        the_managed_arena = MakeTraceArena(the_managed_arena, "The Managed Arena");
+        the_pinned_arena  = MakeTraceArena(the_pinned_arena,  "The  Pinned Arena");
+        the_cpu_arena     = MakeTraceArena(the_cpu_arena,     "The     Cpu Arena");
+    }
+}
+
+void
+Arena::PushTraceTag (std::string tag)
+{
+    if (!arena_trace) return;
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (std::this_thread::get_id() == trace_main_thread) {
+        trace_tags.push_back(std::move(tag));
+    }
+}
+
+void
+Arena::PopTraceTag ()
+{
+    if (!arena_trace) return;
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (std::this_thread::get_id() == trace_main_thread && !trace_tags.empty()) {
+        trace_tags.pop_back();
+    }
+}
+
+void
+Arena::PrintTrace ()
+{
+    if (!arena_trace) return;
+
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    const Long MB = 1024*1024;
+
+    Arena* arenas[] = {the_arena, the_device_arena, the_managed_arena,
+                       the_pinned_arena, the_cpu_arena};
+
+    amrex::Print() << "Arena allocation trace:\n";
+
+    for (Arena* a : arenas)
+    {
+        TraceArena* ta = dynamic_cast<TraceArena*>(a);
+        if (ta == nullptr) continue;
+
+        TraceStats st;
+        {
+            std::lock_guard<std::mutex> lock(trace_mutex);
+            st = trace_arena_stats[ta->id()];
+        }
+        Long cur_min = st.current / MB,    cur_max = cur_min;
+        Long hwm_min = st.high_water / MB, hwm_max = hwm_min;
+        Long n_min = st.nallocs,           n_max = n_min;
+        ParallelReduce::Min<Long>({cur_min, hwm_min, n_min}, IOProc, ParallelDescriptor::Communicator());
+        ParallelReduce::Max<Long>({cur_max, hwm_max, n_max}, IOProc, ParallelDescriptor::Communicator());
+
+        const std::string& name = trace_arena_names[ta->id()];
+        amrex::Print() << "[" << name << "] current (MB): [" << cur_min << " ... " << cur_max
+                       << "]  high-water (MB): [" << hwm_min << " ... " << hwm_max
+                       << "]  allocations: [" << n_min << " ... " << n_max << "]\n";
+
+        if (CArena* ca = dynamic_cast<CArena*>(ta->arena()))
+        {
+            // The fragmentation is the fraction of the free space that is
+            // not in the largest free block.
+            const Long free_space = ca->free_space_available();
+            const Long largest = ca->largest_free_block();
+            Real frag = (free_space > 0) ? 1.0_rt - Real(largest)/Real(free_space) : 0.0_rt;
+            Long heap_min = ca->heap_space_used() / MB, heap_max = heap_min;
+            Long hunks_min = ca->num_hunks(),           hunks_max = hunks_min;
+            Long free_min = free_space / MB,            free_max = free_min;
+            ParallelReduce::Min<Long>({heap_min, hunks_min, free_min}, IOProc,
+                                      ParallelDescriptor::Communicator());
+            ParallelReduce::Max<Long>({heap_max, hunks_max, free_max}, IOProc,
+                                      ParallelDescriptor::Communicator());
+            ParallelDescriptor::ReduceRealMax(frag, IOProc);
+            amrex::Print() << "[" << name << "] heap (MB): [" << heap_min << " ... " << heap_max
+                           << "] in [" << hunks_min << " ... " << hunks_max
+                           << "] hunks  free (MB): [" << free_min << " ... " << free_max
+                           << "]  max fragmentation: " << frag << "\n";
+        }
+    }
+
+    // The tags are only reported for the rank with the largest high-water
+    // usage, because different ranks may have different tags.
+    Long hwm;
+    {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        hwm = trace_total_stats.high_water;
+    }
+    Long hwm_max = hwm;
+    ParallelDescriptor::ReduceLongMax(hwm_max);
+    int rank = (hwm == hwm_max) ? ParallelDescriptor::MyProc() : ParallelDescriptor::NProcs();
+    ParallelDescriptor::ReduceIntMin(rank);
+
+    if (ParallelDescriptor::MyProc() == rank)
+    {
+        std::vector<std::pair<std::string,TraceStats> > tags;
+        {
+            std::lock_guard<std::mutex> lock(trace_mutex);
+            for (int i = 0, N = trace_tag_names.size(); i < N; ++i) {
+                tags.emplace_back(trace_tag_names[i], trace_tag_stats[i]);
+            }
+        }
+        std::sort(tags.begin(), tags.end(),
+                  [] (std::pair<std::string,TraceStats> const& a,
+                      std::pair<std::string,TraceStats> const& b)
+                  { return a.second.high_water > b.second.high_water; });
+        if (static_cast<int>(tags.size()) > arena_trace_ntags) tags.resize(arena_trace_ntags);
+
+        std::ostringstream os;
+        os << "Arena allocation trace of rank " << rank << " (high-water "
+           << hwm / MB << " MB):\n"
+           << "  high-water (MB)  current (MB)  allocations  tag\n";
+        for (auto const& t : tags) {
+            os << "  " << std::setw(15) << t.second.high_water / MB
+               << "  " << std::setw(12) << t.second.current / MB
+               << "  " << std::setw(11) << t.second.nallocs
+               << "  " << t.first << "\n";
+        }
+        amrex::AllPrint() << os.str();
+    }
+    ParallelDescriptor::Barrier();
 }
 
 void
@@ -260,28 +626,19 @@ Arena::PrintUsage ()
     }
 #endif
     if (The_Arena()) {
-        CArena* p = dynamic_cast<CArena*>(The_Arena());
-        if (p) {
-            p->PrintUsage("The         Arena");
-        }
+        PrintArenaUsage(The_Arena(), "The         Arena");
     }
     if (The_Device_Arena()) {
-        CArena* p = dynamic_cast<CArena*>(The_Device_Arena());
-        if (p) {
-            p->PrintUsage("The  Device Arena");
-        }
+        PrintArenaUsage(The_Device_Arena(), "The  Device Arena");
     }
     if (The_Managed_Arena()) {
-        CArena* p = dynamic_cast<CArena*>(The_Managed_Arena());
-        if (p) {
-            p->PrintUsage("The Managed Arena");
-        }
+        PrintArenaUsage(The_Managed_Arena(), "The Managed Arena");
     }
     if (The_Pinned_Arena()) {
-        CArena* p = dynamic_cast<CArena*>(The_Pinned_Arena());
-        if (p) {
-            p->PrintUsage("The  Pinned Arena");
-        }
+        PrintArenaUsage(The_Pinned_Arena(), "The  Pinned Arena");
+    }
+    if (The_Cpu_Arena()) {
+        PrintArenaUsage(The_Cpu_Arena(), "The     Cpu Arena");
     }
 }
     
@@ -295,6 +652,8 @@ Arena::Finalize ()
 #endif
         PrintUsage();
     }
+
+    PrintTrace();
     
     initialized = false;
     
@@ -312,6 +671,15 @@ Arena::Finalize ()
 
     delete the_cpu_arena;
     the_cpu_arena = nullptr;
+
+    trace_tags.clear();
+    trace_records.clear();
+    trace_tag_ids.clear();
+    trace_tag_names.clear();
+    trace_tag_stats.clear();
+    trace_arena_stats.clear();
+    trace_arena_names.clear();
+    trace_total_stats = TraceStats();
 }
     
 Arena*
@@ -17,6 +17,7 @@ namespace {
 int s_asyncout = false;
 int s_noutfiles = 64;
 MPI_Comm s_comm = MPI_COMM_NULL;
+MPI_Comm s_comm_all = MPI_COMM_NULL; // for SubmitAfterAll
 
 std::unique_ptr<std::thread> s_thread;
 std::mutex s_mutx;
@@ -26,6 +27,11 @@ static bool s_finalizing = false;
 
 WriteInfo s_info;
 
+Long s_mem_limit = 0;
+Long s_staged = 0;
+std::mutex s_mem_mutx;
+std::condition_variable s_mem_cond;
+
 void do_job ()
 {
     while (true)
@@ -47,6 +53,9 @@ void Initialize ()
     ParmParse pp("amrex");
     pp.query("async_out", s_asyncout);
     pp.query("async_out_nfiles", s_noutfiles);
+    Long mem_mb = 0;
+    pp.query("async_out_mem_mb", mem_mb);
+    s_mem_limit = std::max(mem_mb, Long(0)) * 1024L * 1024L;
 
     int nprocs = ParallelDescriptor::NProcs();
     s_noutfiles = std::min(s_noutfiles, nprocs);
@@ -63,6 +72,12 @@ void Initialize ()
 #endif
     }
 
+#ifdef AMREX_MPI_THREAD_MULTIPLE
+    if (s_asyncout and nprocs > 1) {
+        MPI_Comm_dup(ParallelDescriptor::Communicator(), &s_comm_all);
+    }
+#endif
+
     if (s_asyncout) s_thread.reset(new std::thread(do_job));
 
     ExecOnFinalize(Finalize);
@@ -79,6 +94,8 @@ void Finalize ()
 #ifdef AMREX_USE_MPI
     if (s_comm != MPI_COMM_NULL) MPI_Comm_free(&s_comm);
     s_comm = MPI_COMM_NULL;
+    if (s_comm_all != MPI_COMM_NULL) MPI_Comm_free(&s_comm_all);
+    s_comm_all = MPI_COMM_NULL;
 #endif
 }
 
@@ -130,6 +147,23 @@ void Finish ()
     }
 }
 
+void Reserve (Long nbytes)
+{
+    std::unique_lock<std::mutex> lck(s_mem_mutx);
+    if (s_thread and s_mem_limit > 0) {
+        s_mem_cond.wait(lck, [=] () -> bool
+                        { return s_staged == 0 or s_staged + nbytes <= s_mem_limit; });
+    }
+    s_staged += nbytes;
+}
+
+void Release (Long nbytes)
+{
+    std::lock_guard<std::mutex> lck(s_mem_mutx);
+    s_staged -= nbytes;
+    s_mem_cond.notify_all();
+}
+
 void Wait ()
 {
 #ifdef AMREX_USE_MPI
@@ -145,6 +179,30 @@ void Wait ()
 #endif
 }
 
+void SubmitAfterAll (std::function<void()>&& a_f)
+{
+#ifdef AMREX_USE_MPI
+    if (s_comm_all != MPI_COMM_NULL) {
+        std::function<void()> f = std::move(a_f);
+        Submit([f] ()
+        {
+            BL_MPI_REQUIRE( MPI_Barrier(s_comm_all) );
+            f();
+        });
+        return;
+    }
+    if (ParallelDescriptor::NProcs() > 1) {
+        // Without MPI_THREAD_MULTIPLE, the background thread cannot call
+        // MPI, so wait for the jobs here.
+        Finish();
+        ParallelDescriptor::Barrier();
+        a_f();
+        return;
+    }
+#endif
+    Submit(std::move(a_f));
+}
+
 void Notify ()
 {
 #ifdef AMREX_USE_MPI
@@ -5,6 +5,10 @@
 #include <AMReX_Utility.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_BaseFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <cstring>
 
 #ifdef AMREX_MEM_PROFILING
 #include <AMReX_MemProfiler.H>
@@ -28,8 +32,413 @@ Long BARef::total_hash_bytes_hwm = 0L;
 bool    BARef::initialized = false;
 bool BoxArray::initialized = false;
 
+BoxArray::IntersectionIndex BoxArray::m_intersection_index = BoxArray::HASH;
+Long BoxArray::m_compact_min_size = 0;
+
 namespace {
     const int bl_ignore_max = 100000;
+
+    // Maximum number of boxes in a leaf of the BVH.
+    constexpr int bvh_leaf_size = 4;
+
+    void bvh_build (BARef& ref, int node, int b, int e)
+    {
+        const auto& abox = ref.m_abox;
+        auto& index = ref.bvh_index;
+
+        Box bbox = abox[index[b]];
+        Box cbox(bbox.smallEnd()+bbox.bigEnd(),
+                 bbox.smallEnd()+bbox.bigEnd());
+        for (int i = b+1; i < e; ++i) {
+            const Box& bx = abox[index[i]];
+            bbox.minBox(bx);
+            const IntVect& c = bx.smallEnd() + bx.bigEnd();
+            cbox.minBox(Box(c,c));
+        }
+
+        if (e - b <= bvh_leaf_size) {
+            ref.bvh[node] = BARef::BVHNode{bbox, b, e-b};
+            return;
+        }
+
+        // Split at the median of the box centers in the longest direction.
+        int dir;
+        cbox.longside(dir);
+        const int m = b + (e-b)/2;
+        std::nth_element(index.begin()+b, index.begin()+m, index.begin()+e,
+                         [&abox,dir] (int i, int j) {
+                             const int ci = abox[i].smallEnd(dir) + abox[i].bigEnd(dir);
+                             const int cj = abox[j].smallEnd(dir) + abox[j].bigEnd(dir);
+                             return ci < cj || (ci == cj && i < j);
+                         });
+
+        const int left = ref.bvh.size();
+        ref.bvh.resize(left+2);
+        ref.bvh[node] = BARef::BVHNode{bbox, left, 0};
+        bvh_build(ref, left  , b, m);
+        bvh_build(ref, left+1, m, e);
+    }
+
+    void bvh_build (BARef& ref)
+    {
+        ref.bvh_index.clear();
+        for (int i = 0, N = ref.m_abox.size(); i < N; ++i) {
+            if (ref.m_abox[i].ok()) {
+                ref.bvh_index.push_back(i);
+            }
+        }
+        ref.bvh.clear();
+        if (!ref.bvh_index.empty()) {
+            ref.bvh.resize(1);
+            bvh_build(ref, 0, 0, ref.bvh_index.size());
+        }
+    }
+
+    // Call f(i) for the boxes in the leaves whose bounding boxes intersect
+    // q, until f returns true.
+    template <class F>
+    void bvh_for_each (const BARef& ref, const Box& q, F&& f)
+    {
+        if (ref.bvh.empty()) return;
+        Vector<int> stack{0};
+        while (!stack.empty())
+        {
+            const BARef::BVHNode& node = ref.bvh[stack.back()];
+            stack.pop_back();
+            if (!node.bx.intersects(q)) continue;
+            if (node.count > 0) {
+                for (int k = node.first; k < node.first+node.count; ++k) {
+                    if (f(ref.bvh_index[k])) return;
+                }
+            } else {
+                stack.push_back(node.first+1);
+                stack.push_back(node.first);
+            }
+        }
+    }
+}
+
+namespace {
+#if defined(BL_USE_MPI3)
+    // Shared memory windows of packed boxes, in the same order on all
+    // processes because they are created collectively.  A window is freed
+    // collectively once no process uses it anymore.
+    struct SharedBoxes
+    {
+        MPI_Win win = MPI_WIN_NULL;
+        bool in_use = true;
+    };
+    Vector<SharedBoxes> shared_boxes;
+    MPI_Comm shared_boxes_comm = MPI_COMM_NULL;
+#endif
+
+    void release_shared_boxes (int id) noexcept
+    {
+#if defined(BL_USE_MPI3)
+        if (id >= 0 && id < static_cast<int>(shared_boxes.size())) {
+            shared_boxes[id].in_use = false;
+        }
+#else
+        amrex::ignore_unused(id);
+#endif
+    }
+}
+
+BoxStorage::BoxStorage (const BoxStorage& rhs)
+    : m_boxes(rhs.m_boxes)
+{
+    copyPacked(rhs);
+}
+
+BoxStorage::BoxStorage (BoxStorage&& rhs) noexcept
+    : m_boxes(std::move(rhs.m_boxes)),
+      m_size(rhs.m_size),
+      m_width(rhs.m_width),
+      m_cuts(std::move(rhs.m_cuts)),
+      m_words(std::move(rhs.m_words)),
+      m_data(rhs.m_data),
+      m_shared_id(rhs.m_shared_id)
+{
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_bits[idim] = rhs.m_bits[idim];
+    }
+    rhs.m_data = nullptr;
+    rhs.m_shared_id = -1;
+    rhs.clearPacked();
+}
+
+BoxStorage&
+BoxStorage::operator= (const BoxStorage& rhs)
+{
+    if (this != &rhs) {
+        clearPacked();
+        m_boxes = rhs.m_boxes;
+        copyPacked(rhs);
+    }
+    return *this;
+}
+
+BoxStorage&
+BoxStorage::operator= (BoxStorage&& rhs) noexcept
+{
+    if (this != &rhs) {
+        clearPacked();
+        m_boxes = std::move(rhs.m_boxes);
+        m_size = rhs.m_size;
+        m_width = rhs.m_width;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            m_bits[idim] = rhs.m_bits[idim];
+        }
+        m_cuts = std::move(rhs.m_cuts);
+        m_words = std::move(rhs.m_words);
+        m_data = rhs.m_data;
+        m_shared_id = rhs.m_shared_id;
+        rhs.m_data = nullptr;
+        rhs.m_shared_id = -1;
+        rhs.clearPacked();
+    }
+    return *this;
+}
+
+BoxStorage&
+BoxStorage::operator= (const Vector<Box>& v)
+{
+    clearPacked();
+    m_boxes = v;
+    return *this;
+}
+
+BoxStorage&
+BoxStorage::operator= (Vector<Box>&& v) noexcept
+{
+    clearPacked();
+    m_boxes = std::move(v);
+    return *this;
+}
+
+BoxStorage::~BoxStorage ()
+{
+    clearPacked();
+}
+
+void
+BoxStorage::clearPacked () noexcept
+{
+    if (m_shared_id >= 0) {
+        release_shared_boxes(m_shared_id);
+        m_shared_id = -1;
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_width = 0;
+    for (auto& c : m_cuts) {
+        Vector<int>().swap(c);
+    }
+    Vector<std::uint64_t>().swap(m_words);
+}
+
+void
+BoxStorage::copyPacked (const BoxStorage& rhs)
+{
+    // A copy of shared data is private.
+    if (rhs.m_data) {
+        m_size = rhs.m_size;
+        m_width = rhs.m_width;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            m_bits[idim] = rhs.m_bits[idim];
+        }
+        m_cuts = rhs.m_cuts;
+        const Long nwords = (m_size*m_width+63)/64 + 1;
+        m_words.assign(rhs.m_data, rhs.m_data+nwords);
+        m_data = m_words.data();
+    }
+}
+
+bool
+BoxStorage::operator== (const BoxStorage& rhs) const noexcept
+{
+    if (m_data == nullptr && rhs.m_data == nullptr) {
+        return m_boxes == rhs.m_boxes;
+    }
+    const Long n = size();
+    if (n != rhs.size()) return false;
+    for (Long i = 0; i < n; ++i) {
+        if ((*this)[i] != rhs[i]) return false;
+    }
+    return true;
+}
+
+Vector<Box>&
+BoxStorage::boxes ()
+{
+    if (m_data) unpack();
+    return m_boxes;
+}
+
+void
+BoxStorage::unpack ()
+{
+    if (m_data == nullptr) return;
+    Vector<Box> bxs(m_size);
+    for (Long i = 0; i < m_size; ++i) {
+        bxs[i] = (*this)[i];
+    }
+    clearPacked();
+    m_boxes = std::move(bxs);
+}
+
+bool
+BoxStorage::pack (bool node_shared)
+{
+    if (m_data) {
+        if (!node_shared || isShared()) return true;
+        unpack();
+    }
+
+    const Long n = m_boxes.size();
+    if (n == 0) return false;
+    for (const auto& b : m_boxes) {
+        if (!b.cellCentered()) return false;
+    }
+
+    Array<Vector<int>,AMREX_SPACEDIM> cuts;
+    int bits[AMREX_SPACEDIM];
+    int width = 0;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        auto& c = cuts[idim];
+        c.reserve(2*n);
+        for (const auto& b : m_boxes) {
+            c.push_back(b.smallEnd(idim));
+            c.push_back(b.bigEnd(idim)+1);
+        }
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        c.shrink_to_fit();
+        bits[idim] = 1;
+        while ((Long(1) << bits[idim]) < static_cast<Long>(c.size())) ++bits[idim];
+        width += 2*bits[idim];
+    }
+    if (width > 64) return false;
+
+    const Long nwords = (n*width+63)/64 + 1;
+    Vector<std::uint64_t> words(nwords, 0);
+    for (Long i = 0; i < n; ++i) {
+        const Box& b = m_boxes[i];
+        std::uint64_t v = 0;
+        int pos = 0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const auto& c = cuts[idim];
+            const std::uint64_t ilo = std::lower_bound(c.begin(), c.end(), b.smallEnd(idim)) - c.begin();
+            const std::uint64_t ihi = std::lower_bound(c.begin(), c.end(), b.bigEnd(idim)+1) - c.begin();
+            v |= ilo << pos;
+            pos += bits[idim];
+            v |= ihi << pos;
+            pos += bits[idim];
+        }
+        const std::uint64_t off = static_cast<std::uint64_t>(i) * width;
+        const std::uint64_t w = off >> 6;
+        const int sh = static_cast<int>(off & 63);
+        words[w] |= v << sh;
+        if (sh + width > 64) words[w+1] |= v >> (64 - sh);
+    }
+
+    Vector<Box>().swap(m_boxes);
+    m_size = n;
+    m_width = width;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_bits[idim] = bits[idim];
+    }
+    m_cuts = std::move(cuts);
+
+#if defined(BL_USE_MPI3)
+    if (node_shared && ParallelDescriptor::NProcs() > 1)
+    {
+        if (shared_boxes_comm == MPI_COMM_NULL) {
+            BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(),
+                                                MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                                                &shared_boxes_comm) );
+        }
+        int node_rank;
+        MPI_Comm_rank(shared_boxes_comm, &node_rank);
+
+        const MPI_Aint win_bytes = (node_rank == 0) ? nwords*sizeof(std::uint64_t) : 0;
+        std::uint64_t* base = nullptr;
+        MPI_Win win;
+        BL_MPI_REQUIRE( MPI_Win_allocate_shared(win_bytes, sizeof(std::uint64_t), MPI_INFO_NULL,
+                                                shared_boxes_comm, &base, &win) );
+        MPI_Aint sz;
+        int disp;
+        BL_MPI_REQUIRE( MPI_Win_shared_query(win, 0, &sz, &disp, &base) );
+        BL_MPI_REQUIRE( MPI_Win_lock_all(MPI_MODE_NOCHECK, win) );
+        if (node_rank == 0) {
+            std::memcpy(base, words.data(), nwords*sizeof(std::uint64_t));
+        }
+        BL_MPI_REQUIRE( MPI_Win_sync(win) );
+        BL_MPI_REQUIRE( MPI_Barrier(shared_boxes_comm) );
+        BL_MPI_REQUIRE( MPI_Win_sync(win) );
+
+        m_shared_id = shared_boxes.size();
+        shared_boxes.push_back(SharedBoxes{win, true});
+        m_data = base;
+        return true;
+    }
+#else
+    amrex::ignore_unused(node_shared);
+#endif
+
+    m_words = std::move(words);
+    m_data = m_words.data();
+    return true;
+}
+
+Long
+BoxStorage::bytes () const noexcept
+{
+    if (m_data == nullptr) return amrex::bytesOf(m_boxes);
+    // Data in shared memory are not counted.
+    Long b = amrex::bytesOf(m_words);
+    for (const auto& c : m_cuts) {
+        b += amrex::bytesOf(c);
+    }
+    return b;
+}
+
+void
+BoxStorage::collectShared ()
+{
+#if defined(BL_USE_MPI3)
+    const int n = shared_boxes.size();
+    if (n == 0) return;
+    Vector<int> in_use(n);
+    for (int i = 0; i < n; ++i) {
+        in_use[i] = shared_boxes[i].in_use;
+    }
+    BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, in_use.data(), n, MPI_INT, MPI_MAX,
+                                  ParallelDescriptor::Communicator()) );
+    for (int i = 0; i < n; ++i) {
+        if (!in_use[i] && shared_boxes[i].win != MPI_WIN_NULL) {
+            MPI_Win_unlock_all(shared_boxes[i].win);
+            MPI_Win_free(&shared_boxes[i].win);
+        }
+    }
+#endif
+}
+
+void
+BoxStorage::finalizeShared ()
+{
+#if defined(BL_USE_MPI3)
+    for (auto& sb : shared_boxes) {
+        if (sb.win != MPI_WIN_NULL) {
+            MPI_Win_unlock_all(sb.win);
+            MPI_Win_free(&sb.win);
+        }
+    }
+    shared_boxes.clear();
+    if (shared_boxes_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&shared_boxes_comm);
+    }
+#endif
 }
 
 BARef::BARef () 
@@ -129,8 +538,8 @@ BARef::define (std::istream& is, int& ndims)
         }
     }
     is.seekg(pos, std::ios_base::beg);
-    for (Vector<Box>::iterator it = m_abox.begin(), End = m_abox.end(); it != End; ++it)
-        is >> *it;
+    for (auto& bx : m_abox.boxes())
+        is >> bx;
     is.ignore(bl_ignore_max, ')');
     if (is.fail())
         amrex::Error("BoxArray::define(istream&) failed");
@@ -181,6 +590,8 @@ BARef::resize (Long n) {
 #endif
     m_abox.resize(n);
     hash.clear();
+    bvh.clear();
+    bvh_index.clear();
     has_hashmap = false;
 #ifdef AMREX_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -192,7 +603,7 @@ void
 BARef::updateMemoryUsage_box (int s)
 {
     if (m_abox.size() > 1) {
-	Long b = amrex::bytesOf(m_abox);
+	Long b = m_abox.bytes();
 	if (s > 0) {
 	    total_box_bytes += b;
 	    total_box_bytes_hwm = std::max(total_box_bytes_hwm, total_box_bytes);
@@ -208,12 +619,13 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
+    if (hash.size() > 0 || bvh.size() > 0) {
 	Long b = sizeof(hash);
 	for (const auto& x: hash) {
 	    b += amrex::gcc_map_node_extra_bytes
 		+ sizeof(IntVect) + amrex::bytesOf(x.second);
 	}
+	b += amrex::bytesOf(bvh) + amrex::bytesOf(bvh_index);
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -260,6 +672,26 @@ BoxArray::Initialize ()
     if (!initialized) {
 	initialized = true;
 	BARef::Initialize();
+
+        ParmParse pp("boxarray");
+        std::string idx;
+        if (pp.query("intersection_index", idx))
+        {
+            if (idx == "HASH") {
+                intersectionIndex(HASH);
+            } else if (idx == "BVH") {
+                intersectionIndex(BVH);
+            } else if (idx == "AUTO") {
+                intersectionIndex(AUTO);
+            } else {
+                std::string msg("Unknown boxarray.intersection_index: ");
+                msg += idx;
+                amrex::Warning(msg.c_str());
+            }
+        }
+
+        m_compact_min_size = 0;
+        pp.query("compact_min_size", m_compact_min_size);
     }
 
     amrex::ExecOnFinalize(BoxArray::Finalize);
@@ -268,6 +700,7 @@ BoxArray::Initialize ()
 void
 BoxArray::Finalize ()
 {
+    BoxStorage::finalizeShared();
     initialized = false;
 }
 
@@ -310,8 +743,9 @@ BoxArray::BoxArray (const Box* bxvec, int nbox)
     m_bat(bxvec->ixType()),
     m_ref(std::make_shared<BARef>(nbox))
 {
+    auto& abox = m_ref->m_abox.boxes();
     for (int i = 0; i < nbox; i++) {
-        m_ref->m_abox[i] = amrex::enclosedCells(*bxvec++);
+        abox[i] = amrex::enclosedCells(*bxvec++);
     }
 }
 
@@ -560,13 +994,14 @@ BoxArray::refine (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-	BL_ASSERT(m_ref->m_abox[i].ok());
-        m_ref->m_abox[i].refine(iv);
+	BL_ASSERT(abox[i].ok());
+        abox[i].refine(iv);
     }
     return *this;
 }
@@ -646,12 +1081,13 @@ BoxArray::growcoarsen (IntVect const& ngrow, const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(ngrow).coarsen(iv);
+        abox[i].grow(ngrow).coarsen(iv);
     }
     return *this;
 }
@@ -661,12 +1097,13 @@ BoxArray::grow (int n)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(n);
+        abox[i].grow(n);
     }
     return *this;
 }
@@ -676,12 +1113,13 @@ BoxArray::grow (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(iv);
+        abox[i].grow(iv);
     }
     return *this;
 }
@@ -692,12 +1130,13 @@ BoxArray::grow (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(dir, n_cell);
+        abox[i].grow(dir, n_cell);
     }
     return *this;
 }
@@ -708,12 +1147,13 @@ BoxArray::growLo (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].growLo(dir, n_cell);
+        abox[i].growLo(dir, n_cell);
     }
     return *this;
 }
@@ -724,12 +1164,13 @@ BoxArray::growHi (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].growHi(dir, n_cell);
+        abox[i].growHi(dir, n_cell);
     }
     return *this;
 }
@@ -803,12 +1244,13 @@ BoxArray::shift (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].shift(dir, nzones);
+        abox[i].shift(dir, nzones);
     }
     return *this;
 }
@@ -818,12 +1260,13 @@ BoxArray::shift (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    auto& abox = m_ref->m_abox.boxes();
+    const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].shift(iv);
+        abox[i].shift(iv);
     }
     return *this;
 }
@@ -835,7 +1278,7 @@ BoxArray::set (int i, const Box& ibox)
     if (i == 0) {
         m_bat.set_index_type(ibox.ixType());
     }
-    m_ref->m_abox[i] = amrex::enclosedCells(ibox);
+    m_ref->m_abox.boxes()[i] = amrex::enclosedCells(ibox);
 }
 
 Box
@@ -1169,7 +1612,23 @@ BoxArray::intersections (const Box&                         bx,
 
     isects.resize(0);
 
-    if (!BoxHashMap.empty())
+    if (!m_ref->bvh.empty())
+    {
+        BL_ASSERT(bx.ixType() == ixType());
+
+        auto& abox = m_ref->m_abox;
+
+        bvh_for_each(*m_ref, bvhQueryBox(amrex::grow(bx,ng)), [&] (int index) -> bool
+        {
+            const Box& isect = bx & amrex::grow(m_bat(abox[index]),ng);
+            if (isect.ok()) {
+                isects.push_back(std::pair<int,Box>(index,isect));
+                return first_only;
+            }
+            return false;
+        });
+    }
+    else if (!BoxHashMap.empty())
     {
         BL_ASSERT(bx.ixType() == ixType());
 
@@ -1266,6 +1725,30 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 
 	BL_ASSERT(bx.ixType() == ixType());
 
+        if (!m_ref->bvh.empty())
+        {
+            BoxList newbl(bl.ixType());
+            BoxList newdiff(bl.ixType());
+
+            auto& abox = m_ref->m_abox;
+
+            bvh_for_each(*m_ref, bvhQueryBox(bx), [&] (int index) -> bool
+            {
+                const Box& isect = bx & m_bat(abox[index]);
+                if (isect.ok())
+                {
+                    newbl.clear();
+                    for (const Box& b : bl) {
+                        amrex::boxDiff(newdiff, b, isect);
+                        newbl.join(newdiff);
+                    }
+                    bl.swap(newbl);
+                }
+                return bl.isEmpty();
+            });
+            return;
+        }
+
 	Box gbx = bx;
 
 	IntVect glo = gbx.smallEnd();
@@ -1359,12 +1842,14 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (!m_ref->hash.empty() || !m_ref->bvh.empty())
     {
 #ifdef AMREX_MEM_PROFILING
 	m_ref->updateMemoryUsage_hash(-1);
 #endif
         m_ref->hash.clear();
+        m_ref->bvh.clear();
+        m_ref->bvh_index.clear();
         m_ref->has_hashmap = false;
     }
 }
@@ -1385,6 +1870,7 @@ BoxArray::removeOverlap (bool simplify)
 
     uniqify();
 
+    auto& abox = m_ref->m_abox.boxes();
     BARef::HashType& BoxHashMap = m_ref->hash;
 
     const Box EmptyBox;
@@ -1401,17 +1887,65 @@ BoxArray::removeOverlap (bool simplify)
 
     BoxList bl_diff;
 
+    getHashMap();
+    const bool use_bvh = !m_ref->bvh.empty();
+    //
+    // The BVH is not updated.  The pieces of a box that has been cut are
+    // found through that box, whose extent contains them.
+    //
+    std::unordered_map<int,std::vector<int> > pieces;
+    std::vector<int> candidates;
+
     for (int i = 0; i < size(); i++)
     {
-        if (m_ref->m_abox[i].ok())
+        if (use_bvh && abox[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+            const Box bxi = abox[i];
+
+            candidates.clear();
+            bvh_for_each(*m_ref, bxi, [&] (int k) -> bool
+            {
+                candidates.push_back(k);
+                return false;
+            });
+
+            while (!candidates.empty())
+            {
+                const int k = candidates.back();
+                candidates.pop_back();
+
+                auto it = pieces.find(k);
+                if (it != pieces.end()) {
+                    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+                    continue;
+                }
+
+                if (k == i) continue;
+
+                const Box& isect = bxi & abox[k];
+                if (!isect.ok()) continue;
+
+                amrex::boxDiff(bl_diff, abox[k], isect);
+
+                abox[k] = EmptyBox;
+
+                auto& kpieces = pieces[k];
+                for (const Box& b : bl_diff)
+                {
+                    abox.push_back(b);
+                    kpieces.push_back(size()-1);
+                }
+            }
+        }
+        else if (abox[i].ok())
+        {
+            intersections(abox[i],isects);
 
             for (int j = 0, N = isects.size(); j < N; j++)
             {
                 if (isects[j].first == i) continue;
 
-                Box& bx = m_ref->m_abox[isects[j].first];
+                Box& bx = abox[isects[j].first];
 
                 amrex::boxDiff(bl_diff, bx, isects[j].second);
 
@@ -1419,7 +1953,7 @@ BoxArray::removeOverlap (bool simplify)
 
                 for (const Box& b : bl_diff)
                 {
-                    m_ref->m_abox.push_back(b);
+                    abox.push_back(b);
                     BoxHashMap[amrex::coarsen(b.smallEnd(),m_ref->crsn)].push_back(size()-1);
                 }
             }
@@ -1432,7 +1966,7 @@ BoxArray::removeOverlap (bool simplify)
     // We now have "holes" in our BoxArray. Make us good.
     //
     BoxList bl(ixType());
-    for (const auto& b : m_ref->m_abox) {
+    for (const auto& b : abox) {
         if (b.ok()) {
             bl.push_back(b);
         }
@@ -1460,11 +1994,40 @@ BoxArray::type_update ()
     {
 	if (not ixType().cellCentered())
 	{
-            for (auto& bx : m_ref->m_abox) {
+            for (auto& bx : m_ref->m_abox.boxes()) {
 		bx.enclosedCells();
 	    }
 	}
+        if (m_compact_min_size > 0 && size() >= m_compact_min_size) {
+            compact();
+        }
+    }
+}
+
+bool
+BoxArray::compact (bool node_shared)
+{
+    if (node_shared) {
+        BoxStorage::collectShared();
     }
+#ifdef AMREX_MEM_PROFILING
+    m_ref->updateMemoryUsage_box(-1);
+#endif
+    const bool r = m_ref->m_abox.pack(node_shared);
+#ifdef AMREX_MEM_PROFILING
+    m_ref->updateMemoryUsage_box(1);
+#endif
+    return r;
+}
+
+Box
+BoxArray::bvhQueryBox (const Box& gbx) const noexcept
+{
+    // The BVH is built on the cell-centered boxes before coarsening.
+    Box q(gbx.smallEnd() - getDoiHi(), gbx.bigEnd() + getDoiLo());
+    q.refine(crseRatio());
+    q.grow(1);
+    return q;
 }
 
 IntVect
@@ -1490,13 +2053,14 @@ BoxArray::getHashMap () const
 #pragma omp critical(intersections_lock)
 #endif
     {
-        if (BoxHashMap.empty() && size() > 0)
+        if (!m_ref->has_hashmap && size() > 0)
         {
             //
             // Calculate the bounding box & maximum extent of the boxes.
             //
 	    IntVect maxext = IntVect::TheUnitVector();
             Box boundingbox = m_ref->m_abox[0];
+            double totpts = 0.0;
 
 	    const int N = size();
 	    for (int i = 0; i < N; ++i)
@@ -1505,13 +2069,29 @@ BoxArray::getHashMap () const
                 bx.normalize();
                 maxext = amrex::max(maxext, bx.size());
                 boundingbox.minBox(bx);
+                totpts += bx.d_numPts();
             }
 
-            for (int i = 0; i < N; i++)
+            // With AUTO, the hash bins are considered too coarse if the
+            // largest box is much bigger than the average box.
+            const double maxpts = AMREX_D_TERM(static_cast<double>(maxext[0]),
+                                               *maxext[1], *maxext[2]);
+            const bool use_bvh = m_intersection_index == BVH ||
+                (m_intersection_index == AUTO && maxpts > 8.0*totpts/N);
+
+            if (use_bvh)
             {
-                const IntVect& crsnsmlend 
-		    = amrex::coarsen(m_ref->m_abox[i].smallEnd(),maxext);
-                BoxHashMap[crsnsmlend].push_back(i);
+                bvh_build(*m_ref);
+            }
+            else
+            {
+                for (int i = 0; i < N; i++)
+                {
+                    const Box bx = m_ref->m_abox[i];
+                    const IntVect& crsnsmlend
+                        = amrex::coarsen(bx.smallEnd(),maxext);
+                    BoxHashMap[crsnsmlend].push_back(i);
+                }
             }
 
             m_ref->crsn = maxext;
@@ -1542,14 +2122,24 @@ BoxArray::uniqify ()
 	auto p = std::make_shared<BARef>(*m_ref);
 	std::swap(m_ref,p);
     }
+    if (m_ref->m_abox.isPacked()) {
+#ifdef AMREX_MEM_PROFILING
+        m_ref->updateMemoryUsage_box(-1);
+#endif
+        m_ref->m_abox.unpack();
+#ifdef AMREX_MEM_PROFILING
+        m_ref->updateMemoryUsage_box(1);
+#endif
+    }
     IntVect cr = crseRatio();
     if (cr != IntVect::TheUnitVector()) {
-        const int N = m_ref->m_abox.size();
+        auto& abox = m_ref->m_abox.boxes();
+        const int N = abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (int i = 0; i < N; i++) {
-            m_ref->m_abox[i].coarsen(cr);
+            abox[i].coarsen(cr);
         }
         m_bat.set_coarsen_ratio(IntVect::TheUnitVector());
     }
@@ -1,5 +1,6 @@
 
 #include <utility>
+#include <algorithm>
 #include <cstring>
 
 #include <AMReX_CArena.H>
@@ -201,6 +202,28 @@ CArena::heap_space_actually_used () const noexcept
     return m_actually_used;
 }
 
+std::size_t
+CArena::free_space_available () const noexcept
+{
+    std::lock_guard<std::mutex> lock(carena_mutex);
+    std::size_t r = 0;
+    for (auto const& node : m_freelist) {
+        r += node.size();
+    }
+    return r;
+}
+
+std::size_t
+CArena::largest_free_block () const noexcept
+{
+    std::lock_guard<std::mutex> lock(carena_mutex);
+    std::size_t r = 0;
+    for (auto const& node : m_freelist) {
+        r = std::max(r, node.size());
+    }
+    return r;
+}
+
 std::size_t
 CArena::sizeOf (void* p) const noexcept
 {
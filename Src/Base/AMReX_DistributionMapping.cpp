@@ -14,6 +14,7 @@
 #include <sstream>
 #include <cstdlib>
 #include <map>
+#include <set>
 #include <vector>
 #include <queue>
 #include <algorithm>
@@ -36,6 +37,15 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    int    graph_ngrow;
+    Real   graph_imbalance;
+    bool   node_aware;
+    //
+    // Lowest global rank on the node of each global rank, found in
+    // Initialize() if node_aware, so that the mapping never needs a
+    // collective call.
+    //
+    Vector<int> node_leader;
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -73,6 +83,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -113,6 +126,9 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9;
     node_size        = 0;
+    graph_ngrow      = 1;
+    graph_imbalance  = 0.05;
+    node_aware       = false;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -123,6 +139,25 @@ DistributionMapping::Initialize ()
     pp.query("sfc_threshold",       sfc_threshold);
     pp.query("node_size",           node_size);
     pp.query("verbose_mapper",      flag_verbose_mapper);
+    pp.query("graph_ngrow",         graph_ngrow);
+    pp.query("graph_imbalance",     graph_imbalance);
+    pp.query("node_aware",          node_aware);
+
+    node_leader.clear();
+#if defined(BL_USE_MPI3)
+    if (node_aware && node_size <= 0)
+    {
+        const MPI_Comm comm = ParallelDescriptor::Communicator();
+        int leader = ParallelDescriptor::MyProc();
+        MPI_Comm node_comm;
+        BL_MPI_REQUIRE( MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0,
+                                            MPI_INFO_NULL, &node_comm) );
+        BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, &leader, 1, MPI_INT, MPI_MIN, node_comm) );
+        BL_MPI_REQUIRE( MPI_Comm_free(&node_comm) );
+        node_leader.resize(ParallelDescriptor::NProcs());
+        ParallelAllGather::AllGather(leader, node_leader.dataPtr(), comm);
+    }
+#endif
 
     std::string theStrategy;
 
@@ -144,6 +179,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -169,6 +208,8 @@ DistributionMapping::Finalize ()
     m_Strategy = SFC;
 
     DistributionMapping::m_BuildMap = 0;
+
+    node_leader.clear();
 }
 
 void
@@ -1011,6 +1052,159 @@ Distribute (const std::vector<SFCToken>&     tokens,
 #endif
 }
 
+//
+// Split tokens [begin,end) into contiguous pieces whose weights follow
+// targets as closely as possible.  Piece i is [r[i],r[i+1]).
+//
+static
+std::vector<int>
+SplitTokens (const std::vector<SFCToken>& tokens,
+             int                          begin,
+             int                          end,
+             const std::vector<Real>&     targets)
+{
+    const int npieces = targets.size();
+    std::vector<int> r(npieces+1, end);
+    r[0] = begin;
+
+    int  K      = begin;
+    Real acc    = 0;
+    Real cumtgt = 0;
+
+    for (int i = 0; i < npieces-1; ++i)
+    {
+        cumtgt += targets[i];
+        const int kbegin = K;
+        while (K < end && end-K > npieces-1-i)
+        {
+            const Real vol = tokens[K].m_vol;
+            if (K > kbegin && acc + 0.5*vol > cumtgt) break;
+            acc += vol;
+            ++K;
+        }
+        r[i+1] = K;
+    }
+
+    return r;
+}
+
+namespace
+{
+    //
+    // Ranks of ParallelContext::CommunicatorSub() grouped by node, in the
+    // order of their lowest ranks.  Nodes are blocks of node_size
+    // consecutive ranks if node_size > 0, and come from the node_leader
+    // found with MPI_COMM_TYPE_SHARED in Initialize() otherwise.  This is
+    // not a collective call; makeSFC may do the mapping on one rank only.
+    //
+    std::vector<std::vector<int> >
+    NodeRanks ()
+    {
+        std::vector<std::vector<int> > nodes;
+        const int nprocs = ParallelContext::NProcsSub();
+        std::map<int,int> node_id;
+        for (int i = 0; i < nprocs; ++i) {
+            int leader = i;
+            if (node_size > 0) {
+                leader = (i/node_size)*node_size;
+            } else if (!node_leader.empty()) {
+                leader = node_leader[ParallelContext::local_to_global_rank(i)];
+            }
+            auto r = node_id.insert(std::make_pair(leader, static_cast<int>(nodes.size())));
+            if (r.second) nodes.emplace_back();
+            nodes[r.first->second].push_back(i);
+        }
+        return nodes;
+    }
+}
+
+//
+// Two-level distribution along the curve: the boxes are first split into
+// one piece per node, in proportion to the numbers of ranks on the nodes,
+// and then each piece is split over the ranks of its node.  If sort, the
+// heaviest piece of a node goes to its least used rank according to ord.
+// Returns the efficiency.
+//
+static
+Real
+DistributeOverNodes (const std::vector<SFCToken>&          tokens,
+                     const std::vector<Long>&              wgts,
+                     const std::vector<std::vector<int> >& nodes,
+                     const Vector<int>&                    ord,
+                     bool                                  sort,
+                     Vector<int>&                          pmap)
+{
+    BL_PROFILE("DistributionMapping::DistributeOverNodes()");
+
+    const int nprocs = ord.size();
+    const int nnodes = nodes.size();
+    const int N = tokens.size();
+
+    Real totalvol = 0;
+    for (const SFCToken& tok : tokens) {
+        totalvol += tok.m_vol;
+    }
+
+    std::vector<Real> node_targets(nnodes);
+    for (int n = 0; n < nnodes; ++n) {
+        node_targets[n] = totalvol*nodes[n].size()/nprocs;
+    }
+    const std::vector<int> nr = SplitTokens(tokens, 0, N, node_targets);
+
+    Vector<int> ord_pos(nprocs);
+    for (int i = 0; i < nprocs; ++i) {
+        ord_pos[ord[i]] = i;
+    }
+
+    std::vector<Long> rank_wgt(nprocs, 0);
+
+    for (int n = 0; n < nnodes; ++n)
+    {
+        const int nranks = nodes[n].size();
+        Real nodevol = 0;
+        for (int K = nr[n]; K < nr[n+1]; ++K) {
+            nodevol += tokens[K].m_vol;
+        }
+        const std::vector<int> rr = SplitTokens(tokens, nr[n], nr[n+1],
+                                                std::vector<Real>(nranks, nodevol/nranks));
+
+        std::vector<std::pair<Long,int> > piece_wgt(nranks);
+        for (int i = 0; i < nranks; ++i) {
+            Long w = 0;
+            for (int K = rr[i]; K < rr[i+1]; ++K) {
+                w += wgts[tokens[K].m_box];
+            }
+            piece_wgt[i] = std::make_pair(w,i);
+        }
+
+        std::vector<int> ranks = nodes[n];
+        if (sort) {
+            std::stable_sort(piece_wgt.begin(), piece_wgt.end(),
+                             [] (const std::pair<Long,int>& a, const std::pair<Long,int>& b)
+                             { return a.first > b.first; });
+            std::stable_sort(ranks.begin(), ranks.end(),
+                             [&] (int a, int b) { return ord_pos[a] < ord_pos[b]; });
+        }
+
+        for (int i = 0; i < nranks; ++i)
+        {
+            const int piece = piece_wgt[i].second;
+            const int rank = ranks[i];
+            rank_wgt[rank] += piece_wgt[i].first;
+            for (int K = rr[piece]; K < rr[piece+1]; ++K) {
+                pmap[tokens[K].m_box] = ParallelContext::local_to_global_rank(rank);
+            }
+        }
+    }
+
+    Real sum_wgt = 0, max_wgt = 0;
+    for (auto w : rank_wgt) {
+        sum_wgt += w;
+        max_wgt = std::max(max_wgt, static_cast<Real>(w));
+    }
+    return sum_wgt/(nprocs*max_wgt);
+}
+
 void
 DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
                                           const std::vector<Long>& wgts,
@@ -1078,6 +1272,33 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
     // Put'm in Morton space filling curve order.
     //
     std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+
+    if (node_aware)
+    {
+        const auto nodes = NodeRanks();
+        const int nnodes = nodes.size();
+        if (nnodes > 1 && nnodes < nprocs)
+        {
+            Vector<int> ord;
+            if (sort) {
+                LeastUsedCPUs(nprocs,ord);
+            } else {
+                ord.resize(nprocs);
+                std::iota(ord.begin(), ord.end(), 0);
+            }
+
+            const Real efficiency = DistributeOverNodes(tokens, wgts, nodes, ord, sort,
+                                                        m_ref->m_pmap);
+            if (eff) *eff = efficiency;
+
+            if (verbose)
+            {
+                amrex::Print() << "SFC efficiency: " << efficiency
+                               << " (" << nnodes << " nodes)\n";
+            }
+            return;
+        }
+    }
     //
     // Split'm up as equitably as possible per team.
     //
@@ -1365,6 +1586,568 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+namespace
+{
+    // Undirected graph in compressed sparse row format.  Each edge is
+    // stored with both of its vertices.
+    struct BoxGraph
+    {
+        std::vector<Long> vwgt;
+        std::vector<int>  xadj;
+        std::vector<int>  adjncy;
+        std::vector<Long> adjwgt;
+
+        int size () const { return vwgt.size(); }
+    };
+
+    // The vertices are the boxes.  The weight of the edge between boxes i
+    // and j is the number of cells of box i grown by ngrow in box j plus
+    // that of box j grown by ngrow in box i.
+    BoxGraph
+    make_box_graph (const BoxArray& ba, const std::vector<Long>& wgts, int ngrow)
+    {
+        BL_PROFILE("make_box_graph()");
+
+        const int N = ba.size();
+
+        BoxGraph g;
+        g.vwgt.assign(wgts.begin(), wgts.end());
+        g.xadj.reserve(N+1);
+
+        std::vector< std::pair<int,Box> > isects;
+
+        for (int i = 0; i < N; ++i)
+        {
+            g.xadj.push_back(g.adjncy.size());
+            const Box& bxi = ba[i];
+            ba.intersections(amrex::grow(bxi,ngrow), isects);
+            for (const auto& is : isects)
+            {
+                const int j = is.first;
+                if (j == i) continue;
+                const Box& bxj = ba[j];
+                const Long w = is.second.numPts() + (amrex::grow(bxj,ngrow) & bxi).numPts();
+                g.adjncy.push_back(j);
+                g.adjwgt.push_back(w);
+            }
+        }
+        g.xadj.push_back(g.adjncy.size());
+
+        return g;
+    }
+
+    Long
+    graph_edge_cut (const BoxGraph& g, const std::vector<int>& part)
+    {
+        Long cut = 0;
+        for (int v = 0, n = g.size(); v < n; ++v) {
+            for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                if (part[g.adjncy[k]] != part[v]) cut += g.adjwgt[k];
+            }
+        }
+        return cut/2;
+    }
+
+    // Heavy edge matching, lightest vertices first.  cmap maps the vertices
+    // of g to those of the returned coarse graph.
+    BoxGraph
+    coarsen_graph (const BoxGraph& g, Long maxvwgt, std::vector<int>& cmap)
+    {
+        const int n = g.size();
+
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&] (int a, int b) { return g.vwgt[a] < g.vwgt[b]; });
+
+        std::vector<int> match(n, -1);
+        for (int v : order)
+        {
+            if (match[v] >= 0) continue;
+            int u = v;
+            Long best = 0;
+            for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                const int w = g.adjncy[k];
+                if (match[w] < 0 && g.adjwgt[k] > best && g.vwgt[v]+g.vwgt[w] <= maxvwgt) {
+                    u = w;
+                    best = g.adjwgt[k];
+                }
+            }
+            match[v] = u;
+            match[u] = v;
+        }
+
+        cmap.assign(n, -1);
+        std::vector<int> first;
+        for (int v = 0; v < n; ++v) {
+            if (cmap[v] < 0) {
+                cmap[v] = cmap[match[v]] = first.size();
+                first.push_back(v);
+            }
+        }
+
+        const int nc = first.size();
+        BoxGraph cg;
+        cg.vwgt.assign(nc, 0);
+        cg.xadj.reserve(nc+1);
+        std::vector<int> where(nc, -1);
+        for (int c = 0; c < nc; ++c)
+        {
+            const int start = cg.adjncy.size();
+            cg.xadj.push_back(start);
+            const int v = first[c];
+            const int nmem = (match[v] == v) ? 1 : 2;
+            for (int m = 0; m < nmem; ++m)
+            {
+                const int fv = (m == 0) ? v : match[v];
+                cg.vwgt[c] += g.vwgt[fv];
+                for (int k = g.xadj[fv]; k < g.xadj[fv+1]; ++k) {
+                    const int cw = cmap[g.adjncy[k]];
+                    if (cw == c) continue;
+                    if (where[cw] < 0) {
+                        where[cw] = cg.adjncy.size();
+                        cg.adjncy.push_back(cw);
+                        cg.adjwgt.push_back(g.adjwgt[k]);
+                    } else {
+                        cg.adjwgt[where[cw]] += g.adjwgt[k];
+                    }
+                }
+            }
+            for (int k = start, e = cg.adjncy.size(); k < e; ++k) {
+                where[cg.adjncy[k]] = -1;
+            }
+        }
+        cg.xadj.push_back(cg.adjncy.size());
+
+        return cg;
+    }
+
+    // Vertices of the subset in breadth first order from start, followed
+    // by the other components of the subset.  A vertex v is in the subset
+    // if mark[v] == id.
+    void
+    bfs_order (const BoxGraph& g, const std::vector<int>& verts, int start,
+               const std::vector<int>& mark, int id,
+               std::vector<int>& visited, int stamp, std::vector<int>& order)
+    {
+        order.clear();
+        std::size_t head = 0;
+        auto seed = verts.begin();
+        int s = start;
+        while (true)
+        {
+            visited[s] = stamp;
+            order.push_back(s);
+            while (head < order.size()) {
+                const int v = order[head++];
+                for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                    const int w = g.adjncy[k];
+                    if (mark[w] == id && visited[w] != stamp) {
+                        visited[w] = stamp;
+                        order.push_back(w);
+                    }
+                }
+            }
+            while (seed != verts.end() && visited[*seed] == stamp) ++seed;
+            if (seed == verts.end()) break;
+            s = *seed;
+        }
+    }
+
+    // Recursive bisection by greedy graph growing: starting from a vertex,
+    // the region takes the neighbor that adds the least to the edge cut
+    // until it holds its share of the weight.  Several start vertices are
+    // tried and the smallest cut is kept.  Parts [p0,p0+np) are assigned
+    // to the vertices in verts.
+    void
+    bisect_graph (const BoxGraph& g, const std::vector<int>& verts, int p0, int np,
+                  std::vector<int>& part, std::vector<int>& mark, std::vector<int>& visited,
+                  int& stamp)
+    {
+        if (np == 1) {
+            for (int v : verts) part[v] = p0;
+            return;
+        }
+
+        const int id = ++stamp;
+        Long total = 0;
+        for (int v : verts) {
+            mark[v] = id;
+            total += g.vwgt[v];
+        }
+
+        std::vector<int> order;
+        bfs_order(g, verts, verts[0], mark, id, visited, ++stamp, order);
+        bfs_order(g, verts, order.back(), mark, id, visited, ++stamp, order);
+
+        const int nl = np/2;
+        const double target = static_cast<double>(total)*nl/np;
+        const int nv = order.size();
+        const int kmax = nv-(np-nl);
+
+        std::vector<int> starts{order[0], order[nv/4], order[nv/2], order[(3*nv)/4], order[nv-1]};
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+        std::vector<Long> gain(g.size());
+        std::vector<int> region, best_region;
+        Long best_cut = std::numeric_limits<Long>::max();
+        using GV = std::pair<Long,int>;
+
+        for (int start : starts)
+        {
+            const int in = ++stamp;
+            for (int v : verts) {
+                gain[v] = 0;
+                for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                    if (mark[g.adjncy[k]] == id) gain[v] -= g.adjwgt[k];
+                }
+            }
+
+            region.clear();
+            std::priority_queue<GV> pq;
+            pq.push(GV(gain[start],start));
+            auto next = order.begin();
+            Long acc = 0;
+            while (static_cast<int>(region.size()) < kmax)
+            {
+                int v = -1;
+                while (!pq.empty()) {
+                    const GV top = pq.top();
+                    pq.pop();
+                    if (visited[top.second] != in && top.first == gain[top.second]) {
+                        v = top.second;
+                        break;
+                    }
+                }
+                if (v < 0) {
+                    while (next != order.end() && visited[*next] == in) ++next;
+                    if (next == order.end()) break;
+                    v = *next;
+                }
+
+                const Long w = g.vwgt[v];
+                if (static_cast<int>(region.size()) >= nl && acc > 0 && acc+w > target) {
+                    if (acc+w-target >= target-acc) break;
+                    visited[v] = in;
+                    region.push_back(v);
+                    break;
+                }
+                visited[v] = in;
+                region.push_back(v);
+                acc += w;
+
+                for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                    const int u = g.adjncy[k];
+                    if (mark[u] == id && visited[u] != in) {
+                        gain[u] += 2*g.adjwgt[k];
+                        pq.push(GV(gain[u],u));
+                    }
+                }
+            }
+
+            Long cut = 0;
+            for (int v : region) {
+                for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                    const int u = g.adjncy[k];
+                    if (mark[u] == id && visited[u] != in) cut += g.adjwgt[k];
+                }
+            }
+            if (cut < best_cut) {
+                best_cut = cut;
+                std::swap(best_region, region);
+            }
+        }
+
+        const int in = ++stamp;
+        for (int v : best_region) visited[v] = in;
+        std::vector<int> right;
+        right.reserve(nv-best_region.size());
+        for (int v : verts) {
+            if (visited[v] != in) right.push_back(v);
+        }
+        std::vector<int> left(std::move(best_region));
+        bisect_graph(g, left , p0   , nl   , part, mark, visited, stamp);
+        bisect_graph(g, right, p0+nl, np-nl, part, mark, visited, stamp);
+    }
+
+    // Greedy k-way refinement: move boundary vertices to the neighboring
+    // part that reduces the edge cut most without exceeding maxload, or
+    // out of parts that exceed maxload.
+    void
+    refine_partition (const BoxGraph& g, int nparts, Long maxload, std::vector<int>& part)
+    {
+        const int n = g.size();
+        std::vector<Long> load(nparts, 0);
+        std::vector<int> count(nparts, 0);
+        for (int v = 0; v < n; ++v) {
+            load[part[v]] += g.vwgt[v];
+            ++count[part[v]];
+        }
+
+        std::vector<Long> conn(nparts, 0);
+        std::vector<int> touched;
+
+        for (int pass = 0; pass < 8; ++pass)
+        {
+            int nmoves = 0;
+            for (int v = 0; v < n; ++v)
+            {
+                const int pv = part[v];
+                if (count[pv] == 1) continue;
+
+                touched.clear();
+                for (int k = g.xadj[v]; k < g.xadj[v+1]; ++k) {
+                    const int p = part[g.adjncy[k]];
+                    if (conn[p] == 0) touched.push_back(p);
+                    conn[p] += g.adjwgt[k];
+                }
+
+                const Long vw = g.vwgt[v];
+                const bool overloaded = load[pv] > maxload;
+                int best = -1;
+                Long bestgain = 0;
+                for (int p : touched) {
+                    if (p == pv || load[p]+vw > maxload) continue;
+                    const Long gain = conn[p] - conn[pv];
+                    bool better;
+                    if (best < 0) {
+                        better = gain > 0 || (gain == 0 && load[p]+vw < load[pv]) || overloaded;
+                    } else {
+                        better = gain > bestgain || (gain == bestgain && load[p] < load[best]);
+                    }
+                    if (better) {
+                        best = p;
+                        bestgain = gain;
+                    }
+                }
+                for (int p : touched) conn[p] = 0;
+
+                if (best >= 0) {
+                    part[v] = best;
+                    load[pv] -= vw;
+                    load[best] += vw;
+                    --count[pv];
+                    ++count[best];
+                    ++nmoves;
+                }
+            }
+            if (nmoves == 0) break;
+        }
+    }
+
+    Long
+    graph_max_load (const BoxGraph& g, int nparts, Real imbalance)
+    {
+        Long total = 0;
+        for (auto w : g.vwgt) total += w;
+        return static_cast<Long>((1.0+imbalance)*static_cast<double>(total)/nparts);
+    }
+
+    // Multilevel k-way partitioning: coarsen by heavy edge matching,
+    // bisect the coarsest graph recursively, and refine while projecting
+    // the partition back to the finer graphs.
+    std::vector<int>
+    partition_graph (const BoxGraph& g, int nparts, Real imbalance)
+    {
+        BL_PROFILE("partition_graph()");
+
+        Long total = 0;
+        for (auto w : g.vwgt) total += w;
+        const Long maxload = graph_max_load(g, nparts, imbalance);
+        const Long maxvwgt = static_cast<Long>(1.5*static_cast<double>(total)/nparts);
+
+        std::vector<BoxGraph> graphs;
+        std::vector<std::vector<int> > cmaps;
+        const BoxGraph* cur = &g;
+        while (cur->size() > 20*nparts)
+        {
+            std::vector<int> cmap;
+            BoxGraph cg = coarsen_graph(*cur, maxvwgt, cmap);
+            if (cg.size() > 0.9*cur->size()) break;
+            graphs.push_back(std::move(cg));
+            cmaps.push_back(std::move(cmap));
+            cur = &graphs.back();
+        }
+
+        std::vector<int> part(cur->size());
+        {
+            std::vector<int> verts(cur->size());
+            std::iota(verts.begin(), verts.end(), 0);
+            std::vector<int> mark(cur->size(), 0), visited(cur->size(), 0);
+            int stamp = 0;
+            bisect_graph(*cur, verts, 0, nparts, part, mark, visited, stamp);
+        }
+        refine_partition(*cur, nparts, maxload, part);
+
+        for (int lev = graphs.size()-1; lev >= 0; --lev)
+        {
+            const BoxGraph& fg = (lev == 0) ? g : graphs[lev-1];
+            const auto& cmap = cmaps[lev];
+            std::vector<int> fpart(fg.size());
+            for (int v = 0, n = fg.size(); v < n; ++v) {
+                fpart[v] = part[cmap[v]];
+            }
+            std::swap(part, fpart);
+            refine_partition(fg, nparts, maxload, part);
+        }
+
+        return part;
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<Long>& wgts,
+                                        int                      nprocs,
+                                        Real*                    efficiency,
+                                        Long*                    edgecut,
+                                        bool                     sort)
+{
+    BL_PROFILE("DistributionMapping::GraphProcessorMap()");
+
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (static_cast<int>(wgts.size()) <= nprocs || nprocs < 2)
+    {
+        RoundRobinProcessorMap(wgts,nprocs);
+
+        if (efficiency) *efficiency = 1;
+        if (edgecut) *edgecut = ComputeEdgeCut(*this, boxes, graph_ngrow);
+        return;
+    }
+
+    const BoxGraph g = make_box_graph(boxes, wgts, graph_ngrow);
+    std::vector<int> part = partition_graph(g, nprocs, graph_imbalance);
+
+    // The space filling curve gives good partitions of compact regions, which
+    // the multilevel scheme does not always find.  So it is refined too, and
+    // the partition with the smaller edge cut is used.
+    {
+        SFCProcessorMapDoIt(boxes, wgts, nprocs, false);
+        std::vector<int> sfc_part(wgts.size());
+        for (int i = 0, N = wgts.size(); i < N; ++i) {
+            sfc_part[i] = ParallelContext::global_to_local_rank(m_ref->m_pmap[i]);
+        }
+        refine_partition(g, nprocs, graph_max_load(g, nprocs, graph_imbalance), sfc_part);
+        if (graph_edge_cut(g, sfc_part) < graph_edge_cut(g, part)) {
+            std::swap(part, sfc_part);
+        }
+    }
+
+    std::vector<LIpair> LIpairV;
+    LIpairV.reserve(nprocs);
+    {
+        std::vector<Long> load(nprocs, 0);
+        for (int i = 0, N = wgts.size(); i < N; ++i) {
+            load[part[i]] += wgts[i];
+        }
+        for (int i = 0; i < nprocs; ++i) {
+            LIpairV.push_back(LIpair(load[i],i));
+        }
+    }
+
+    if (sort) Sort(LIpairV, true);
+
+    Vector<int> ord;
+    if (sort) {
+        LeastUsedCPUs(nprocs,ord);
+    } else {
+        ord.resize(nprocs);
+        std::iota(ord.begin(), ord.end(), 0);
+    }
+
+    // The heaviest part goes to the least used process.
+    Vector<int> part_rank(nprocs);
+    for (int i = 0; i < nprocs; ++i) {
+        part_rank[LIpairV[i].second] = ord[i];
+    }
+
+    for (int i = 0, N = wgts.size(); i < N; ++i) {
+        m_ref->m_pmap[i] = ParallelContext::local_to_global_rank(part_rank[part[i]]);
+    }
+
+    if (efficiency || edgecut || verbose)
+    {
+        Real sum_wgt = 0, max_wgt = 0;
+        for (const auto& p : LIpairV)
+        {
+            if (p.first > max_wgt) max_wgt = p.first;
+            sum_wgt += p.first;
+        }
+        const Real eff = sum_wgt/(nprocs*max_wgt);
+        const Long cut = graph_edge_cut(g, part);
+        if (efficiency) *efficiency = eff;
+        if (edgecut) *edgecut = cut;
+
+        if (verbose)
+        {
+            amrex::Print() << "GRAPH efficiency: " << eff << ", edge cut: " << cut << '\n';
+        }
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes,
+                                        int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    std::vector<Long> wgts;
+    wgts.reserve(boxes.size());
+
+    for (int i = 0, N = boxes.size(); i < N; ++i)
+    {
+        wgts.push_back(boxes[i].numPts());
+    }
+
+    GraphProcessorMap(boxes,wgts,nprocs);
+}
+
+Long
+DistributionMapping::ComputeEdgeCut (const DistributionMapping& dm, const BoxArray& ba, int ngrow)
+{
+    BL_ASSERT(dm.size() == ba.size());
+
+    const BoxGraph g = make_box_graph(ba, std::vector<Long>(ba.size(),1), ngrow);
+    return graph_edge_cut(g, dm.ProcessorMap());
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba)
+{
+    Real eff;
+    Long edgecut;
+    return makeGraph(rcost, ba, eff, edgecut);
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba,
+                                Real& eff, Long& edgecut)
+{
+    BL_PROFILE("makeGraph");
+
+    DistributionMapping r;
+
+    Vector<Long> cost(rcost.size());
+
+    Real wmax = *std::max_element(rcost.begin(), rcost.end());
+    Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+    for (int i = 0; i < rcost.size(); ++i) {
+        cost[i] = Long(rcost[i]*scale) + 1L;
+    }
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.GraphProcessorMap(ba, cost, nprocs, &eff, &edgecut);
+
+    return r;
+}
+
 DistributionMapping
 DistributionMapping::makeKnapSack (const Vector<Real>& rcost, int nmax)
 {
@@ -1476,6 +2259,126 @@ DistributionMapping::makeKnapSack (const LayoutData<Real>& rcost_local,
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeIncremental (const LayoutData<Real>& rcost_local,
+                                      const LayoutData<Real>& rbytes_local,
+                                      Real& currentEfficiency, Real& proposedEfficiency,
+                                      Real targetEfficiency, Long maxBytesMoved,
+                                      bool broadcastToAll, int root)
+{
+    BL_PROFILE("makeIncremental");
+
+    const DistributionMapping& dm = rcost_local.DistributionMap();
+    AMREX_ALWAYS_ASSERT(rbytes_local.DistributionMap() == dm);
+
+    Vector<Real> rcost(rcost_local.size());
+    Vector<Real> rbytes(rbytes_local.size());
+    ParallelDescriptor::GatherLayoutDataToVector<Real>(rcost_local, rcost, root);
+    ParallelDescriptor::GatherLayoutDataToVector<Real>(rbytes_local, rbytes, root);
+
+    const int N = rcost.size();
+    Vector<int> pmap(N);
+
+    if (ParallelDescriptor::MyProc() == root)
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+
+        pmap = dm.ProcessorMap();
+
+        ComputeDistributionMappingEfficiency(dm, rcost, &currentEfficiency);
+
+        Vector<Real> load(nprocs, 0.0);
+        Vector<Vector<int> > rank_boxes(nprocs);
+        Real total = 0.0;
+        for (int i = 0; i < N; ++i) {
+            load[pmap[i]] += rcost[i];
+            rank_boxes[pmap[i]].push_back(i);
+            total += rcost[i];
+        }
+        const Real target_load = (total/nprocs)/std::max(targetEfficiency, Real(1.e-6));
+
+        // Ranks ordered by load
+        std::set<std::pair<Real,int> > ranks;
+        for (int p = 0; p < nprocs; ++p) {
+            ranks.insert(std::make_pair(load[p],p));
+        }
+
+        std::vector<bool> moved(N, false);
+        Long bytes_moved = 0;
+        int nmoves = 0;
+
+        while (true)
+        {
+            const int p = ranks.rbegin()->second;
+            const int q = ranks.begin()->second;
+            if (p == q || load[p] <= target_load) break;
+
+            // The box whose move to q reduces the load of p the most per byte.
+            int best = -1;
+            Real best_score = 0.0, best_reduction = 0.0;
+            for (int i : rank_boxes[p])
+            {
+                if (moved[i]) continue;
+                const Long b = static_cast<Long>(std::max(rbytes[i], Real(0.0)));
+                if (maxBytesMoved >= 0 && bytes_moved + b > maxBytesMoved) continue;
+                const Real reduction = load[p] - std::max(load[p]-rcost[i], load[q]+rcost[i]);
+                if (reduction <= 0.0) continue;
+                const Real score = reduction/(b+1);
+                if (score > best_score || (score == best_score && reduction > best_reduction)) {
+                    best = i;
+                    best_score = score;
+                    best_reduction = reduction;
+                }
+            }
+            if (best < 0) break;
+
+            ranks.erase(std::make_pair(load[p],p));
+            ranks.erase(std::make_pair(load[q],q));
+            load[p] -= rcost[best];
+            load[q] += rcost[best];
+            ranks.insert(std::make_pair(load[p],p));
+            ranks.insert(std::make_pair(load[q],q));
+
+            auto& bp = rank_boxes[p];
+            bp.erase(std::find(bp.begin(), bp.end(), best));
+            rank_boxes[q].push_back(best);
+            pmap[best] = q;
+            moved[best] = true;
+            bytes_moved += static_cast<Long>(std::max(rbytes[best], Real(0.0)));
+            ++nmoves;
+        }
+
+        Real max_load = 0.0;
+        for (auto l : load) max_load = std::max(max_load, l);
+        proposedEfficiency = (max_load > 0.0) ? total/(nprocs*max_load) : Real(1.0);
+
+        if (verbose)
+        {
+            amrex::Print(root) << "INCREMENTAL efficiency: " << currentEfficiency
+                               << " -> " << proposedEfficiency << ", " << nmoves
+                               << " boxes and " << bytes_moved << " bytes moved\n";
+        }
+    }
+
+#ifdef BL_USE_MPI
+    if (broadcastToAll)
+    {
+        ParallelDescriptor::Bcast(pmap.data(), pmap.size(), root);
+    }
+    else if (ParallelDescriptor::MyProc() != root)
+    {
+        return DistributionMapping();
+    }
+#endif
+
+    // Keep the current one if nothing moves, so that the caches built for it are reused.
+    if (pmap == dm.ProcessorMap()) {
+        return dm;
+    } else {
+        return DistributionMapping(std::move(pmap));
+    }
+}
+
 void
 DistributionMapping::ComputeDistributionMappingEfficiency (const DistributionMapping& dm,
                                                            const Vector<Real>& cost,
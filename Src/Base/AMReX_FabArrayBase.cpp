@@ -1,5 +1,11 @@
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <numeric>
 #include <AMReX_FabArrayBase.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
@@ -24,6 +30,13 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::use_persistent_fb;
+bool    FabArrayBase::use_shmem_fb;
+bool    FabArrayBase::use_comm_tasks;
+bool    FabArrayBase::use_neighbor_fb;
+bool    FabArrayBase::use_aggregated_fb;
+bool    FabArrayBase::use_local_boxarray_index;
+bool    FabArrayBase::first_touch;
 
 #if defined(AMREX_USE_GPU)
 
@@ -67,6 +80,14 @@ FabArrayBase::CacheStats           FabArrayBase::m_CPC_stats("CopyCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FPinfo_stats("FillPatchCache");
 FabArrayBase::CacheStats           FabArrayBase::m_CFinfo_stats("CrseFineCache");
 
+FabArrayBase::CommCompressionStats FabArrayBase::m_CommComp_stats;
+
+Long FabArrayBase::fb_cache_max_bytes;
+Long FabArrayBase::cpc_cache_max_bytes;
+Long FabArrayBase::cfinfo_cache_max_bytes;
+Long FabArrayBase::m_cache_clock = 0;
+int  FabArrayBase::m_no_cache_eviction = 0;
+
 std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
@@ -78,6 +99,13 @@ namespace
 {
     Arena* the_fa_arena = nullptr;
     bool initialized = false;
+#if defined(BL_USE_MPI3)
+    // Processes of ParallelDescriptor::Communicator() on this node, shared
+    // by all the persistent plans.
+    MPI_Comm the_node_comm = MPI_COMM_NULL;
+#endif
+    // Counter for FabArrayBase::FB::m_coll_seq.
+    Long the_fb_coll_seq = 0;
 }
 
 void
@@ -90,6 +118,16 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::use_persistent_fb = false;
+    FabArrayBase::use_shmem_fb      = false;
+    FabArrayBase::use_comm_tasks    = false;
+    FabArrayBase::use_neighbor_fb   = false;
+    FabArrayBase::use_aggregated_fb = false;
+    FabArrayBase::use_local_boxarray_index = false;
+    FabArrayBase::first_touch       = false;
+    FabArrayBase::fb_cache_max_bytes     = -1;
+    FabArrayBase::cpc_cache_max_bytes    = -1;
+    FabArrayBase::cfinfo_cache_max_bytes = -1;
 
     ParmParse pp("fabarray");
 
@@ -111,6 +149,32 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("use_persistent_fb",   FabArrayBase::use_persistent_fb);
+    pp.query("use_shmem_fb",        FabArrayBase::use_shmem_fb);
+    pp.query("use_comm_tasks",      FabArrayBase::use_comm_tasks);
+    pp.query("use_neighbor_fb",     FabArrayBase::use_neighbor_fb);
+    pp.query("use_aggregated_fb",   FabArrayBase::use_aggregated_fb);
+    pp.query("use_local_boxarray_index", FabArrayBase::use_local_boxarray_index);
+    pp.query("first_touch",         FabArrayBase::first_touch);
+    pp.query("fb_cache_max_bytes",     FabArrayBase::fb_cache_max_bytes);
+    pp.query("cpc_cache_max_bytes",    FabArrayBase::cpc_cache_max_bytes);
+    pp.query("cfinfo_cache_max_bytes", FabArrayBase::cfinfo_cache_max_bytes);
+
+#if !defined(BL_USE_MPI3) || defined(AMREX_USE_GPU)
+    // The shared memory path needs MPI-3 and buffers on the host.
+    FabArrayBase::use_shmem_fb = false;
+#endif
+#if !defined(BL_USE_MPI3)
+    // Neighborhood collectives are new in MPI-3.
+    FabArrayBase::use_neighbor_fb = false;
+#endif
+#if defined(BL_USE_MPI3)
+    if (FabArrayBase::use_shmem_fb) {
+        BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(),
+                                            MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                                            &the_node_comm) );
+    }
+#endif
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -255,7 +319,7 @@ FabArrayBase::CPC::bytes () const
 Long
 FabArrayBase::FB::bytes () const
 {
-    int cnt = sizeof(FabArrayBase::FB);
+    Long cnt = sizeof(FabArrayBase::FB);
 
     if (m_LocTags)
 	cnt += amrex::bytesOf(*m_LocTags);
@@ -266,9 +330,567 @@ FabArrayBase::FB::bytes () const
     if (m_RcvTags)
 	cnt += FabArrayBase::bytesOfMapOfCopyComTagContainers(*m_RcvTags);
 
+    return cnt + planBytes();
+}
+
+Long
+FabArrayBase::FB::planBytes () const
+{
+    Long cnt = 0;
+    for (auto const& kv : m_persistent_plans) {
+        cnt += kv.second->bytes();
+    }
+    return cnt;
+}
+
+FabArrayBase::PersistentPlan::~PersistentPlan ()
+{
+#ifdef BL_USE_MPI
+    BL_ASSERT(!in_use);
+    waitAcks();
+    if (nbr_req != MPI_REQUEST_NULL) MPI_Request_free(&nbr_req);
+    for (auto& r : send_reqs) {
+        if (r != MPI_REQUEST_NULL) MPI_Request_free(&r);
+    }
+    for (auto& r : recv_reqs) {
+        if (r != MPI_REQUEST_NULL) MPI_Request_free(&r);
+    }
+    for (auto& r : ack_send_reqs) {
+        if (r != MPI_REQUEST_NULL) MPI_Request_free(&r);
+    }
+    for (auto& r : ack_recv_reqs) {
+        if (r != MPI_REQUEST_NULL) MPI_Request_free(&r);
+    }
+#if defined(BL_USE_MPI3)
+    // Collective over the processes on the node.  node_comm is shared.
+    if (win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(win);
+        MPI_Win_free(&win);
+    }
+#endif
+#endif
+    if (the_send_data) The_FA_Arena()->free(the_send_data);
+    if (the_recv_data) The_FA_Arena()->free(the_recv_data);
+}
+
+#ifdef BL_USE_MPI
+namespace {
+    // Set up a persistent request for a message of nbytes using the same
+    // data type selection as ParallelDescriptor::Asend/Arecv.
+    void persistent_init (bool is_send, char* p, std::size_t nbytes, int rank,
+                          int tag, MPI_Comm comm, MPI_Request* req)
+    {
+        const int comm_data_type = ParallelDescriptor::select_comm_data_type(nbytes);
+        MPI_Datatype t;
+        int n;
+        if (comm_data_type == 1) {
+            t = ParallelDescriptor::Mpi_typemap<char>::type();
+            n = nbytes;
+        } else if (comm_data_type == 2) {
+            t = ParallelDescriptor::Mpi_typemap<unsigned long long>::type();
+            n = nbytes/sizeof(unsigned long long);
+        } else if (comm_data_type == 3) {
+            t = ParallelDescriptor::Mpi_typemap<ParallelDescriptor::lull_t>::type();
+            n = nbytes/sizeof(ParallelDescriptor::lull_t);
+        } else {
+            amrex::Abort("TODO: message size is too big");
+        }
+        if (is_send) {
+            BL_MPI_REQUIRE( MPI_Send_init(p, n, t, rank, tag, comm, req) );
+        } else {
+            BL_MPI_REQUIRE( MPI_Recv_init(p, n, t, rank, tag, comm, req) );
+        }
+    }
+}
+#endif
+
+void
+FabArrayBase::PersistentPlan::define (std::size_t value_align)
+{
+#ifdef BL_USE_MPI
+    const int nsend = send_size.size();
+    const int nrecv = recv_size.size();
+
+    // Rank in node_comm of the processes on the same node, -1 otherwise.
+    Vector<int> send_node_rank(nsend, -1);
+    Vector<int> recv_node_rank(nrecv, -1);
+
+#if defined(BL_USE_MPI3)
+    // The window is allocated collectively over the node, so all the
+    // processes on the node must take part, as they do when comm is the
+    // full communicator.
+    if (use_shmem_fb && the_node_comm != MPI_COMM_NULL &&
+        comm == ParallelDescriptor::Communicator())
+    {
+        node_comm = the_node_comm;
+
+        MPI_Group group, node_group;
+        BL_MPI_REQUIRE( MPI_Comm_group(comm, &group) );
+        BL_MPI_REQUIRE( MPI_Comm_group(node_comm, &node_group) );
+
+        auto translate = [&] (Vector<int> const& ranks, Vector<int>& node_ranks)
+        {
+            const int n = ranks.size();
+            if (n == 0) return;
+            Vector<int> lranks(n);
+            for (int i = 0; i < n; ++i) {
+                lranks[i] = ParallelContext::global_to_local_rank(ranks[i]);
+            }
+            BL_MPI_REQUIRE( MPI_Group_translate_ranks(group, n, lranks.data(),
+                                                      node_group, node_ranks.data()) );
+            for (auto& r : node_ranks) {
+                if (r == MPI_UNDEFINED) r = -1;
+            }
+        };
+        translate(send_rank, send_node_rank);
+        translate(recv_from, recv_node_rank);
+
+        MPI_Group_free(&node_group);
+        MPI_Group_free(&group);
+    }
+#endif
+
+    // Buffers for messages that go through MPI
+    auto alloc_buffers = [this,value_align] (Vector<std::size_t>& sizes,
+                                        Vector<int> const& node_rank,
+                                        Vector<char*>& data) -> char*
+    {
+        Vector<std::size_t> offset;
+        std::size_t total_volume = 0;
+        for (int i = 0, N = sizes.size(); i < N; ++i) {
+            std::size_t& nbytes = sizes[i];
+            std::size_t acd = ParallelDescriptor::alignof_comm_data(nbytes);
+            nbytes = amrex::aligned_size(acd, nbytes);
+            total_volume = amrex::aligned_size(std::max(value_align,acd), total_volume);
+            offset.push_back(total_volume);
+            if (node_rank[i] < 0) total_volume += nbytes;
+        }
+        data.assign(sizes.size(), nullptr);
+        char* the_data = nullptr;
+        buffer_bytes += total_volume;
+        if (total_volume > 0) {
+            the_data = static_cast<char*>(The_FA_Arena()->alloc(total_volume));
+            for (int i = 0, N = sizes.size(); i < N; ++i) {
+                if (sizes[i] > 0 && node_rank[i] < 0) data[i] = the_data + offset[i];
+            }
+        }
+        return the_data;
+    };
+
+    the_send_data = alloc_buffers(send_size, send_node_rank, send_data);
+    the_recv_data = alloc_buffers(recv_size, recv_node_rank, recv_data);
+
+    send_reqs.assign(nsend, MPI_REQUEST_NULL);
+    recv_reqs.assign(nrecv, MPI_REQUEST_NULL);
+
+#if defined(BL_USE_MPI3) && (MPI_VERSION >= 4)
+    if (nbr_comm != MPI_COMM_NULL)
+    {
+        // All the messages are exchanged by a single persistent collective.
+        NeighborCounts(the_send_data, send_data, send_size,
+                       the_recv_data, recv_data, recv_size, nbr_counts);
+        const MPI_Datatype chr = ParallelDescriptor::Mpi_typemap<char>::type();
+        const int* c = nbr_counts.data();
+        BL_MPI_REQUIRE( MPI_Neighbor_alltoallv_init(the_send_data, c, c+nsend, chr,
+                                                    the_recv_data, c+2*nsend, c+2*nsend+nrecv,
+                                                    chr, nbr_comm, MPI_INFO_NULL, &nbr_req) );
+        return;
+    }
+#endif
+
+#if defined(BL_USE_MPI3)
+    if (node_comm != MPI_COMM_NULL)
+    {
+        // Send buffers for the processes on the same node
+        Vector<unsigned long long> win_offset(nsend, 0);
+        win_bytes = 0;
+        for (int i = 0; i < nsend; ++i) {
+            if (send_node_rank[i] >= 0) {
+                win_bytes = amrex::aligned_size(std::max(value_align,
+                                                         alignof(std::max_align_t)),
+                                                win_bytes);
+                win_offset[i] = win_bytes;
+                win_bytes += send_size[i];
+            }
+        }
+
+        MPI_Info info;
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "alloc_shared_noncontig", "true");
+        char* base = nullptr;
+        BL_MPI_REQUIRE( MPI_Win_allocate_shared(win_bytes, 1, info, node_comm,
+                                                &base, &win) );
+        MPI_Info_free(&info);
+        BL_MPI_REQUIRE( MPI_Win_lock_all(MPI_MODE_NOCHECK, win) );
+
+        // Tell the receivers where their data are in our window.
+        const MPI_Datatype ull = ParallelDescriptor::Mpi_typemap<unsigned long long>::type();
+        Vector<unsigned long long> recv_offset(nrecv, 0);
+        Vector<MPI_Request> reqs;
+        for (int i = 0; i < nrecv; ++i) {
+            if (recv_node_rank[i] >= 0 && recv_size[i] > 0) {
+                reqs.push_back(MPI_REQUEST_NULL);
+                const int rank = ParallelContext::global_to_local_rank(recv_from[i]);
+                BL_MPI_REQUIRE( MPI_Irecv(&recv_offset[i], 1, ull, rank, tag, comm,
+                                          &reqs.back()) );
+            }
+        }
+        for (int i = 0; i < nsend; ++i) {
+            if (send_node_rank[i] >= 0 && send_size[i] > 0) {
+                send_data[i] = base + win_offset[i];
+                reqs.push_back(MPI_REQUEST_NULL);
+                const int rank = ParallelContext::global_to_local_rank(send_rank[i]);
+                BL_MPI_REQUIRE( MPI_Isend(&win_offset[i], 1, ull, rank, tag, comm,
+                                          &reqs.back()) );
+            }
+        }
+        if (!reqs.empty()) {
+            Vector<MPI_Status> stats(reqs.size());
+            ParallelDescriptor::Waitall(reqs, stats);
+        }
+
+        for (int i = 0; i < nrecv; ++i) {
+            if (recv_node_rank[i] >= 0 && recv_size[i] > 0) {
+                MPI_Aint sz;
+                int disp_unit;
+                char* p = nullptr;
+                BL_MPI_REQUIRE( MPI_Win_shared_query(win, recv_node_rank[i], &sz,
+                                                     &disp_unit, &p) );
+                recv_data[i] = p + recv_offset[i];
+            }
+        }
+    }
+#endif
+
+    const MPI_Datatype chr = ParallelDescriptor::Mpi_typemap<char>::type();
+
+    // For the processes on the same node, only zero-byte messages are sent.
+    for (int i = 0; i < nrecv; ++i) {
+        if (recv_size[i] > 0) {
+            const int rank = ParallelContext::global_to_local_rank(recv_from[i]);
+            if (recv_node_rank[i] < 0) {
+                persistent_init(false, recv_data[i], recv_size[i], rank, tag, comm, &recv_reqs[i]);
+            } else {
+                BL_MPI_REQUIRE( MPI_Recv_init(nullptr, 0, chr, rank, tag, comm, &recv_reqs[i]) );
+                ack_send_reqs.push_back(MPI_REQUEST_NULL);
+                BL_MPI_REQUIRE( MPI_Send_init(nullptr, 0, chr, rank, ack_tag, comm,
+                                              &ack_send_reqs.back()) );
+            }
+        }
+    }
+    for (int i = 0; i < nsend; ++i) {
+        if (send_size[i] > 0) {
+            const int rank = ParallelContext::global_to_local_rank(send_rank[i]);
+            if (send_node_rank[i] < 0) {
+                persistent_init(true, send_data[i], send_size[i], rank, tag, comm, &send_reqs[i]);
+            } else {
+                BL_MPI_REQUIRE( MPI_Send_init(nullptr, 0, chr, rank, tag, comm, &send_reqs[i]) );
+                ack_recv_reqs.push_back(MPI_REQUEST_NULL);
+                BL_MPI_REQUIRE( MPI_Recv_init(nullptr, 0, chr, rank, ack_tag, comm,
+                                              &ack_recv_reqs.back()) );
+            }
+        }
+    }
+#else
+    amrex::ignore_unused(value_align);
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::startRecvs ()
+{
+#ifdef BL_USE_MPI
+    for (auto& r : recv_reqs) {
+        if (r != MPI_REQUEST_NULL) BL_MPI_REQUIRE( MPI_Start(&r) );
+    }
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::startSends ()
+{
+#ifdef BL_USE_MPI
+#if defined(BL_USE_MPI3)
+    // Make the packed data visible to the other processes on the node.
+    if (win != MPI_WIN_NULL) MPI_Win_sync(win);
+#endif
+    for (auto& r : send_reqs) {
+        if (r != MPI_REQUEST_NULL) BL_MPI_REQUIRE( MPI_Start(&r) );
+    }
+    if (nbr_req != MPI_REQUEST_NULL) BL_MPI_REQUIRE( MPI_Start(&nbr_req) );
+    for (auto& r : ack_recv_reqs) {
+        BL_MPI_REQUIRE( MPI_Start(&r) );
+    }
+    ack_pending = !ack_recv_reqs.empty();
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::waitRecvs ()
+{
+#ifdef BL_USE_MPI
+    if (!recv_reqs.empty()) {
+        Vector<MPI_Status> stats(recv_reqs.size());
+        ParallelDescriptor::Waitall(recv_reqs, stats);
+    }
+    if (nbr_req != MPI_REQUEST_NULL) BL_MPI_REQUIRE( MPI_Wait(&nbr_req, MPI_STATUS_IGNORE) );
+#if defined(BL_USE_MPI3)
+    if (win != MPI_WIN_NULL) MPI_Win_sync(win);
+#endif
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::waitSends ()
+{
+#ifdef BL_USE_MPI
+    if (!send_reqs.empty()) {
+        Vector<MPI_Status> stats(send_reqs.size());
+        ParallelDescriptor::Waitall(send_reqs, stats);
+    }
+    if (!ack_send_reqs.empty()) {
+        Vector<MPI_Status> stats(ack_send_reqs.size());
+        ParallelDescriptor::Waitall(ack_send_reqs, stats);
+    }
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::waitAcks ()
+{
+#ifdef BL_USE_MPI
+    if (ack_pending) {
+        Vector<MPI_Status> stats(ack_recv_reqs.size());
+        ParallelDescriptor::Waitall(ack_recv_reqs, stats);
+        ack_pending = false;
+#if defined(BL_USE_MPI3)
+        MPI_Win_sync(win);
+#endif
+    }
+#endif
+}
+
+void
+FabArrayBase::PersistentPlan::sendAcks ()
+{
+#ifdef BL_USE_MPI
+#if defined(BL_USE_MPI3)
+    if (win != MPI_WIN_NULL) MPI_Win_sync(win);
+#endif
+    for (auto& r : ack_send_reqs) {
+        BL_MPI_REQUIRE( MPI_Start(&r) );
+    }
+#endif
+}
+
+Long
+FabArrayBase::PersistentPlan::bytes () const
+{
+    Long cnt = sizeof(PersistentPlan) + buffer_bytes + win_bytes
+        + amrex::bytesOf(send_data) + amrex::bytesOf(send_size)
+        + amrex::bytesOf(send_rank) + amrex::bytesOf(send_reqs)
+        + amrex::bytesOf(recv_data) + amrex::bytesOf(recv_size)
+        + amrex::bytesOf(recv_from) + amrex::bytesOf(recv_reqs)
+        + amrex::bytesOf(ack_send_reqs) + amrex::bytesOf(ack_recv_reqs)
+        + amrex::bytesOf(nbr_counts);
     return cnt;
 }
 
+namespace {
+
+    // Compressed message layout: a header of two 64-bit words (method and
+    // number of bytes of the whole message), followed by either the raw
+    // data (method 0), or (method 1) one 4-bit code per value giving the
+    // number of leading zero bytes of the value XOR'ed with the previous
+    // value, followed by the remaining bytes of the XOR'ed values.  This
+    // is lossless for any data.
+    constexpr std::size_t comm_header_size = 2*sizeof(std::uint64_t);
+
+    template <typename T>
+    std::size_t comm_compress (const char* src, std::size_t nbytes, char* dst)
+    {
+        const std::size_t n = nbytes / sizeof(T);
+        const std::size_t ncode = (n+1)/2;
+        if (nbytes != n*sizeof(T) || comm_header_size + ncode >= nbytes) return 0;
+
+        unsigned char* code = reinterpret_cast<unsigned char*>(dst + comm_header_size);
+        unsigned char* out = code + ncode;
+        // Give up if the compressed data are not smaller than the raw data.
+        const unsigned char* end = reinterpret_cast<unsigned char*>(dst + nbytes);
+        std::memset(code, 0, ncode);
+
+        T prev = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            T v;
+            std::memcpy(&v, src + i*sizeof(T), sizeof(T));
+            T x = v ^ prev;
+            prev = v;
+            int nb = 0; // # of significant bytes
+            for (T y = x; y != 0; y >>= 8) ++nb;
+            if (out + nb > end) return 0;
+            code[i/2] |= static_cast<unsigned char>((sizeof(T)-nb) << ((i%2)*4));
+            for (int b = 0; b < nb; ++b) {
+                *out++ = static_cast<unsigned char>(x >> (8*b));
+            }
+        }
+        return reinterpret_cast<char*>(out) - dst;
+    }
+
+    template <typename T>
+    void comm_decompress (const char* src, char* dst, std::size_t nbytes)
+    {
+        const std::size_t n = nbytes / sizeof(T);
+        const std::size_t ncode = (n+1)/2;
+        const unsigned char* code = reinterpret_cast<const unsigned char*>(src + comm_header_size);
+        const unsigned char* in = code + ncode;
+
+        T prev = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const int nb = sizeof(T) - ((code[i/2] >> ((i%2)*4)) & 0xF);
+            T x = 0;
+            for (int b = 0; b < nb; ++b) {
+                x |= static_cast<T>(*in++) << (8*b);
+            }
+            prev ^= x;
+            std::memcpy(dst + i*sizeof(T), &prev, sizeof(T));
+        }
+    }
+}
+
+std::size_t
+FabArrayBase::CommCompressedCapacity (std::size_t nbytes)
+{
+#ifdef BL_USE_MPI
+    std::size_t n = nbytes + comm_header_size;
+    return amrex::aligned_size(ParallelDescriptor::alignof_comm_data(n), n);
+#else
+    return nbytes + comm_header_size;
+#endif
+}
+
+char*
+FabArrayBase::CompressSendBuffers (char* the_send_data, Vector<char*>& send_data,
+                                   Vector<std::size_t>& send_size, int value_size)
+{
+    BL_PROFILE("FabArrayBase::CompressSendBuffers()");
+
+    const int N = send_data.size();
+    Vector<std::size_t> offset(N);
+    std::size_t total_volume = 0;
+    for (int i = 0; i < N; ++i) {
+        total_volume = amrex::aligned_size(alignof(std::uint64_t), total_volume);
+        offset[i] = total_volume;
+        if (send_data[i]) total_volume += CommCompressedCapacity(send_size[i]);
+    }
+
+    char* the_data = nullptr;
+    if (total_volume > 0) {
+        the_data = static_cast<char*>(The_FA_Arena()->alloc(total_volume));
+    }
+
+    Vector<int> compressed(N, 0);
+    const Vector<std::size_t> raw_size = send_size;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < N; ++i)
+    {
+        if (send_data[i] == nullptr) continue;
+
+        char* p = the_data + offset[i];
+        const std::size_t capacity = CommCompressedCapacity(send_size[i]);
+
+#ifdef BL_USE_MPI
+        // Messages that need a large MPI datatype are sent with the full
+        // capacity so that both sides use the same datatype.
+        const bool small_msg = ParallelDescriptor::select_comm_data_type(capacity) == 1;
+#else
+        const bool small_msg = true;
+#endif
+        std::size_t n = 0;
+        if (small_msg) {
+            if (value_size == 8) {
+                n = comm_compress<std::uint64_t>(send_data[i], send_size[i], p);
+            } else if (value_size == 4) {
+                n = comm_compress<std::uint32_t>(send_data[i], send_size[i], p);
+            }
+        }
+
+        std::uint64_t header[2];
+        if (n > 0) {
+            header[0] = 1;
+            compressed[i] = 1;
+        } else {
+            header[0] = 0;
+            std::memcpy(p + comm_header_size, send_data[i], send_size[i]);
+            n = small_msg ? send_size[i] + comm_header_size : capacity;
+        }
+        header[1] = n;
+        std::memcpy(p, header, comm_header_size);
+
+        send_data[i] = p;
+        send_size[i] = n;
+    }
+
+    for (int i = 0; i < N; ++i) {
+        if (send_data[i]) {
+            m_CommComp_stats.recordMessage(raw_size[i], send_size[i], compressed[i]);
+        }
+    }
+
+    if (the_send_data) The_FA_Arena()->free(the_send_data);
+
+    return the_data;
+}
+
+char*
+FabArrayBase::DecompressRecvBuffers (char* the_recv_data, Vector<char*>& recv_data,
+                                     Vector<std::size_t> const& recv_size, int value_size)
+{
+    BL_PROFILE("FabArrayBase::DecompressRecvBuffers()");
+
+    const int N = recv_data.size();
+    Vector<std::size_t> offset(N);
+    std::size_t total_volume = 0;
+    for (int i = 0; i < N; ++i) {
+        total_volume = amrex::aligned_size(alignof(std::uint64_t), total_volume);
+        offset[i] = total_volume;
+        if (recv_data[i]) total_volume += recv_size[i];
+    }
+
+    char* the_data = nullptr;
+    if (total_volume > 0) {
+        the_data = static_cast<char*>(The_FA_Arena()->alloc(total_volume));
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < N; ++i)
+    {
+        if (recv_data[i] == nullptr) continue;
+
+        char* p = the_data + offset[i];
+        std::uint64_t header[2];
+        std::memcpy(header, recv_data[i], comm_header_size);
+        if (header[0] == 1) {
+            if (value_size == 8) {
+                comm_decompress<std::uint64_t>(recv_data[i], p, recv_size[i]);
+            } else {
+                comm_decompress<std::uint32_t>(recv_data[i], p, recv_size[i]);
+            }
+        } else {
+            std::memcpy(p, recv_data[i] + comm_header_size, recv_size[i]);
+        }
+        recv_data[i] = p;
+    }
+
+    if (the_recv_data) The_FA_Arena()->free(the_recv_data);
+
+    return the_data;
+}
+
 Long
 FabArrayBase::TileArray::bytes () const
 {
@@ -294,6 +916,8 @@ FabArrayBase::CPC::CPC (const FabArrayBase& dstfa, const IntVect& dstng,
       m_period(period),
       m_srcba(srcfa.boxArray()), 
       m_dstba(dstfa.boxArray()),
+      m_srcdm(srcfa.DistributionMap()),
+      m_dstdm(dstfa.DistributionMap()),
       m_nuse(0)
 {
     this->define(m_dstba, dstfa.DistributionMap(), dstfa.IndexArray(), 
@@ -312,6 +936,8 @@ FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm,
       m_period(period),
       m_srcba(srcba), 
       m_dstba(dstba),
+      m_srcdm(srcdm),
+      m_dstdm(dstdm),
       m_nuse(0)
 {
     this->define(dstba, dstdm, dstidx, srcba, srcdm, srcidx, myproc);
@@ -320,6 +946,66 @@ FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm,
 FabArrayBase::CPC::~CPC ()
 {}
 
+namespace {
+
+    // Intersections with the boxes of a BoxArray.  After restrictTo, only
+    // the boxes intersecting the given regions are indexed, so that the
+    // index of the whole BoxArray is not needed.
+    class NearbyBoxes
+    {
+    public:
+        explicit NearbyBoxes (const BoxArray& ba) : m_ba(ba) {}
+
+        void restrictTo (const BoxList& regions)
+        {
+            if (regions.size() >= m_ba.size()) return;
+
+            const BoxArray rba(regions);
+            BoxList bl(m_ba.ixType());
+            for (int k = 0, N = m_ba.size(); k < N; ++k)
+            {
+                const Box& bx = m_ba[k];
+                if (rba.intersects(bx)) {
+                    bl.push_back(bx);
+                    m_global.push_back(k);
+                }
+            }
+            m_sub = BoxArray(std::move(bl));
+            m_local = true;
+        }
+
+        void intersections (const Box& bx, std::vector< std::pair<int,Box> >& isects,
+                            bool first_only, const IntVect& ng) const
+        {
+            if (!m_local) {
+                m_ba.intersections(bx, isects, first_only, ng);
+            } else if (m_sub.empty()) {
+                isects.clear();
+            } else {
+                m_sub.intersections(bx, isects, first_only, ng);
+                for (auto& is : isects) {
+                    is.first = m_global[is.first];
+                }
+            }
+        }
+
+    private:
+        const BoxArray& m_ba;
+        bool m_local = false;
+        BoxArray m_sub;
+        Vector<int> m_global;
+    };
+
+    void merge_comm_tags (FabArrayBase::MapOfCopyComTagContainers& to,
+                          FabArrayBase::MapOfCopyComTagContainers& from)
+    {
+        for (auto& kv : from) {
+            auto& v = to[kv.first];
+            v.insert(v.end(), kv.second.begin(), kv.second.end());
+        }
+    }
+}
+
 void
 FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm_dst,
 			   const Vector<int>& imap_dst,
@@ -343,39 +1029,28 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	const int nlocal_dst = imap_dst.size();
 	const IntVect& ng_dst = m_dstng;
 
-	std::vector< std::pair<int,Box> > isects;
-
 	const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
 
-	auto& send_tags = *m_SndTags;
-	
-	for (int i = 0; i < nlocal_src; ++i)
-	{
-	    const int   k_src = imap_src[i];
-	    const Box& bx_src = amrex::grow(ba_src[k_src], ng_src);
-
-	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
-	    {
-		ba_dst.intersections(bx_src+(*pit), isects, false, ng_dst);
-	    
-		for (int j = 0, M = isects.size(); j < M; ++j)
-		{
-		    const int k_dst     = isects[j].first;
-		    const Box& bx       = isects[j].second;
-		    const int dst_owner = dm_dst[k_dst];
-		
-		    if (ParallelDescriptor::sameTeam(dst_owner)) {
-			continue; // local copy will be dealt with later
-		    } else if (MyProc == dm_src[k_src]) {
-			send_tags[dst_owner].push_back(CopyComTag(bx, bx-(*pit), k_dst, k_src));
-		    }
-		}
-	    }
-	}
+        NearbyBoxes dst_boxes(ba_dst), src_boxes(ba_src);
+        if (FabArrayBase::use_local_boxarray_index)
+        {
+            BoxList dst_regions(ba_dst.ixType());
+            for (int i = 0; i < nlocal_src; ++i) {
+                for (const auto& iv : pshifts) {
+                    dst_regions.push_back(amrex::grow(amrex::grow(ba_src[imap_src[i]],ng_src)+iv, ng_dst));
+                }
+            }
+            dst_boxes.restrictTo(dst_regions);
 
-	auto& recv_tags = *m_RcvTags;
+            BoxList src_regions(ba_src.ixType());
+            for (int i = 0; i < nlocal_dst; ++i) {
+                for (const auto& iv : pshifts) {
+                    src_regions.push_back(amrex::grow(amrex::grow(ba_dst[imap_dst[i]],ng_dst)+iv, ng_src));
+                }
+            }
+            src_boxes.restrictTo(src_regions);
+        }
 
-	BaseFab<int> localtouch(The_Cpu_Arena()), remotetouch(The_Cpu_Arena());
 	bool check_local = false, check_remote = false;
 #if defined(_OPENMP)
 	if (omp_get_max_threads() > 1) {
@@ -394,61 +1069,128 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
         m_threadsafe_loc = not check_local;
         m_threadsafe_rcv = not check_remote;
 
-	for (int i = 0; i < nlocal_dst; ++i)
-	{
-	    const int   k_dst = imap_dst[i];
-	    const Box& bx_dst = amrex::grow(ba_dst[k_dst], ng_dst);
+        // Local tags are kept in the order of the destination boxes.
+        Vector<CopyComTag::CopyComTagsContainer> loc_tags(nlocal_dst);
+        bool threadsafe_loc = true, threadsafe_rcv = true;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(&&:threadsafe_loc,threadsafe_rcv)
+#endif
+        {
+	    std::vector< std::pair<int,Box> > isects;
+            CopyComTag::MapOfCopyComTagContainers send_tags, recv_tags;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+	    for (int i = 0; i < nlocal_src; ++i)
+	    {
+	        const int   k_src = imap_src[i];
+	        const Box& bx_src = amrex::grow(ba_src[k_src], ng_src);
+
+	        for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
+	        {
+		    dst_boxes.intersections(bx_src+(*pit), isects, false, ng_dst);
 	    
-	    if (check_local) {
-		localtouch.resize(bx_dst);
-		localtouch.setVal<RunOn::Host>(0);
-	    }
-	    
-	    if (check_remote) {
-		remotetouch.resize(bx_dst);
-		remotetouch.setVal<RunOn::Host>(0);
+		    for (int j = 0, M = isects.size(); j < M; ++j)
+		    {
+		        const int k_dst     = isects[j].first;
+		        const Box& bx       = isects[j].second;
+		        const int dst_owner = dm_dst[k_dst];
+		
+		        if (ParallelDescriptor::sameTeam(dst_owner)) {
+			    continue; // local copy will be dealt with later
+		        } else if (MyProc == dm_src[k_src]) {
+			    send_tags[dst_owner].push_back(CopyComTag(bx, bx-(*pit), k_dst, k_src));
+		        }
+		    }
+	        }
 	    }
-	    
-	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
+
+	    BaseFab<int> localtouch(The_Cpu_Arena()), remotetouch(The_Cpu_Arena());
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+	    for (int i = 0; i < nlocal_dst; ++i)
 	    {
-		ba_src.intersections(bx_dst+(*pit), isects, false, ng_src);
+	        const int   k_dst = imap_dst[i];
+	        const Box& bx_dst = amrex::grow(ba_dst[k_dst], ng_dst);
+
+                // keep checking thread safety if it is safe so far
+                const bool chk_local = check_local && threadsafe_loc;
+                const bool chk_remote = check_remote && threadsafe_rcv;
+
+	        if (chk_local) {
+		    localtouch.resize(bx_dst);
+		    localtouch.setVal<RunOn::Host>(0);
+	        }
 	    
-		for (int j = 0, M = isects.size(); j < M; ++j)
-		{
-		    const int k_src     = isects[j].first;
-		    const Box& bx       = isects[j].second - *pit;
-		    const int src_owner = dm_src[k_src];
+	        if (chk_remote) {
+		    remotetouch.resize(bx_dst);
+		    remotetouch.setVal<RunOn::Host>(0);
+	        }
+	    
+	        for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
+	        {
+		    src_boxes.intersections(bx_dst+(*pit), isects, false, ng_src);
+	    
+		    for (int j = 0, M = isects.size(); j < M; ++j)
+		    {
+		        const int k_src     = isects[j].first;
+		        const Box& bx       = isects[j].second - *pit;
+		        const int src_owner = dm_src[k_src];
 		
-		    if (ParallelDescriptor::sameTeam(src_owner, MyProc)) { // local copy
-			const BoxList tilelist(bx, FabArrayBase::comm_tile_size);
-			for (BoxList::const_iterator
-				 it_tile  = tilelist.begin(),
-				 End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
-			{
-			    m_LocTags->push_back(CopyComTag(*it_tile, (*it_tile)+(*pit), k_dst, k_src));
-			}
-			if (check_local) {
-			    localtouch.plus<RunOn::Host>(1, bx);
-			}
-		    } else if (MyProc == dm_dst[k_dst]) {
-			recv_tags[src_owner].push_back(CopyComTag(bx, bx+(*pit), k_dst, k_src));
-			if (check_remote) {
-			    remotetouch.plus<RunOn::Host>(1, bx);
-			}
+		        if (ParallelDescriptor::sameTeam(src_owner, MyProc)) { // local copy
+			    const BoxList tilelist(bx, FabArrayBase::comm_tile_size);
+			    for (BoxList::const_iterator
+				     it_tile  = tilelist.begin(),
+				     End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
+			    {
+			        loc_tags[i].push_back(CopyComTag(*it_tile, (*it_tile)+(*pit), k_dst, k_src));
+			    }
+			    if (chk_local) {
+			        localtouch.plus<RunOn::Host>(1, bx);
+			    }
+		        } else if (MyProc == dm_dst[k_dst]) {
+			    recv_tags[src_owner].push_back(CopyComTag(bx, bx+(*pit), k_dst, k_src));
+			    if (chk_remote) {
+			        remotetouch.plus<RunOn::Host>(1, bx);
+			    }
+		        }
 		    }
-		}
-	    }
+	        }
 	    
-	    if (check_local) {  
-		// safe if a cell is touched no more than once 
-		// keep checking thread safety if it is safe so far
-		check_local = m_threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
-	    }
+	        if (chk_local) {  
+		    // safe if a cell is touched no more than once 
+		    threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
+	        }
 	    
-	    if (check_remote) {
-		check_remote = m_threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
+	        if (chk_remote) {
+		    threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
+	        }
 	    }
-	}
+
+#ifdef _OPENMP
+#pragma omp critical(cpc_define_merge)
+#endif
+            {
+                merge_comm_tags(*m_SndTags, send_tags);
+                merge_comm_tags(*m_RcvTags, recv_tags);
+            }
+        }
+
+        for (auto& v : loc_tags) {
+            m_LocTags->insert(m_LocTags->end(), v.begin(), v.end());
+        }
+
+        if (check_local) {
+            m_threadsafe_loc = threadsafe_loc;
+        }
+
+        if (check_remote) {
+            m_threadsafe_rcv = threadsafe_rcv;
+        }
 	
 	for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
 	{
@@ -472,6 +1214,8 @@ FabArrayBase::CPC::CPC (const BoxArray& ba, const IntVect& ng,
       m_period(),
       m_srcba(ba), 
       m_dstba(ba),
+      m_srcdm(srcdm),
+      m_dstdm(dstdm),
       m_nuse(0)
 {
     BL_ASSERT(ba.size() > 0);
@@ -534,9 +1278,7 @@ FabArrayBase::flushCPC (bool no_assertion) const
 	    }
 	}
 
-#ifdef AMREX_MEM_PROFILING
 	m_CPC_stats.bytes -= it->second->bytes();
-#endif
 	m_CPC_stats.recordErase(it->second->m_nuse);
 	delete it->second;
     }
@@ -561,9 +1303,47 @@ FabArrayBase::flushCPCache ()
 	}
     }
     m_TheCPCache.clear();
-#ifdef AMREX_MEM_PROFILING
     m_CPC_stats.bytes = 0L;
-#endif
+}
+
+void
+FabArrayBase::trimCPCache (const BDKey& keep_src, const BDKey& keep_dst)
+{
+    if (cpc_cache_max_bytes < 0 || m_no_cache_eviction > 0) return;
+
+    while (m_CPC_stats.bytes > cpc_cache_max_bytes)
+    {
+        CPCacheIter victim = m_TheCPCache.end();
+        for (CPCacheIter it = m_TheCPCache.begin(); it != m_TheCPCache.end(); ++it)
+        {
+            const CPC* cpc = it->second;
+            if ((cpc->m_srcbdk != keep_src || cpc->m_dstbdk != keep_dst) &&
+                (victim == m_TheCPCache.end() ||
+                 cpc->m_last_use < victim->second->m_last_use))
+            {
+                victim = it;
+            }
+        }
+        if (victim == m_TheCPCache.end()) break;
+
+        // A CPC is stored under both its source and destination keys.
+        CPC* cpc = victim->second;
+        for (const BDKey& key : {cpc->m_srcbdk, cpc->m_dstbdk})
+        {
+            std::pair<CPCacheIter,CPCacheIter> er_it = m_TheCPCache.equal_range(key);
+            for (CPCacheIter it = er_it.first; it != er_it.second; ++it)
+            {
+                if (it->second == cpc) {
+                    m_TheCPCache.erase(it);
+                    break;
+                }
+            }
+        }
+
+        m_CPC_stats.bytes -= cpc->bytes();
+        m_CPC_stats.recordEvict(cpc->m_nuse);
+        delete cpc;
+    }
 }
 
 const FabArrayBase::CPC&
@@ -591,7 +1371,8 @@ FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVe
 	    it->second->m_dstba  == boxArray())
 	{
 	    ++(it->second->m_nuse);
-	    m_CPC_stats.recordUse();
+	    it->second->m_last_use = ++m_cache_clock;
+	    m_CPC_stats.recordHit();
 	    return *(it->second);
 	}
     }
@@ -599,12 +1380,10 @@ FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVe
     // Have to build a new one
     CPC* new_cpc = new CPC(*this, dstng, src, srcng, period);
 
-#ifdef AMREX_MEM_PROFILING
-    m_CPC_stats.bytes += new_cpc->bytes();
-    m_CPC_stats.bytes_hwm = std::max(m_CPC_stats.bytes_hwm, m_CPC_stats.bytes);
-#endif    
+    m_CPC_stats.recordBytes(new_cpc->bytes());
 
     new_cpc->m_nuse = 1;
+    new_cpc->m_last_use = ++m_cache_clock;
     m_CPC_stats.recordBuild();
     m_CPC_stats.recordUse();
 
@@ -612,6 +1391,8 @@ FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVe
     if (srckey != dstkey)
 	m_TheCPCache.insert(          CPCache::value_type(srckey,new_cpc));
 
+    trimCPCache(srckey, dstkey);
+
     return *new_cpc;
 }
 
@@ -656,41 +1437,21 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
     
     const int nlocal = imap.size();
     const IntVect& ng = m_ngrow;
-    std::vector< std::pair<int,Box> > isects;
     
     const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
-    
-    auto& send_tags = *m_SndTags;
-    
-    for (int i = 0; i < nlocal; ++i)
-    {
-	const int ksnd = imap[i];
-	const Box& vbx = ba[ksnd];
-	
-	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
-	{
-	    ba.intersections(vbx+(*pit), isects, false, ng);
 
-	    for (int j = 0, M = isects.size(); j < M; ++j)
-	    {
-		const int krcv      = isects[j].first;
-		const Box& bx       = isects[j].second;
-		const int dst_owner = dm[krcv];
-		
-		if (ParallelDescriptor::sameTeam(dst_owner)) {
-		    continue;  // local copy will be dealt with later
-		} else if (MyProc == dm[ksnd]) {
-		    const BoxList& bl = amrex::boxDiff(bx, ba[krcv]);
-		    for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
-			send_tags[dst_owner].push_back(CopyComTag(*lit, (*lit)-(*pit), krcv, ksnd));
-		}
-	    }
-	}
+    NearbyBoxes boxes(ba);
+    if (FabArrayBase::use_local_boxarray_index)
+    {
+        BoxList regions(ba.ixType());
+        for (int i = 0; i < nlocal; ++i) {
+            for (const auto& iv : pshifts) {
+                regions.push_back(amrex::grow(ba[imap[i]]+iv, ng));
+            }
+        }
+        boxes.restrictTo(regions);
     }
 
-    auto& recv_tags = *m_RcvTags;
-
-    BaseFab<int> localtouch(The_Cpu_Arena()), remotetouch(The_Cpu_Arena());
     bool check_local = false, check_remote = false;
 #if defined(_OPENMP)
     if (omp_get_max_threads() > 1) {
@@ -709,67 +1470,136 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
     m_threadsafe_loc = not check_local;
     m_threadsafe_rcv = not check_remote;
 
-    for (int i = 0; i < nlocal; ++i)
+    // Local tags are kept in the order of the receiving boxes.
+    Vector<CopyComTag::CopyComTagsContainer> loc_tags(nlocal);
+    bool threadsafe_loc = true, threadsafe_rcv = true;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(&&:threadsafe_loc,threadsafe_rcv)
+#endif
     {
-	const int   krcv = imap[i];
-	const Box& vbx   = ba[krcv];
-	const Box& bxrcv = amrex::grow(vbx, ng);
+        std::vector< std::pair<int,Box> > isects;
+        CopyComTag::MapOfCopyComTagContainers send_tags, recv_tags;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+        for (int i = 0; i < nlocal; ++i)
+        {
+	    const int ksnd = imap[i];
+	    const Box& vbx = ba[ksnd];
 	
-	if (check_local) {
-	    localtouch.resize(bxrcv);
-	    localtouch.setVal<RunOn::Host>(0);
-	}
+	    for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+	    {
+	        boxes.intersections(vbx+(*pit), isects, false, ng);
+
+	        for (int j = 0, M = isects.size(); j < M; ++j)
+	        {
+		    const int krcv      = isects[j].first;
+		    const Box& bx       = isects[j].second;
+		    const int dst_owner = dm[krcv];
+		
+		    if (ParallelDescriptor::sameTeam(dst_owner)) {
+		        continue;  // local copy will be dealt with later
+		    } else if (MyProc == dm[ksnd]) {
+		        const BoxList& bl = amrex::boxDiff(bx, ba[krcv]);
+		        for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+			    send_tags[dst_owner].push_back(CopyComTag(*lit, (*lit)-(*pit), krcv, ksnd));
+		    }
+	        }
+	    }
+        }
+
+        BaseFab<int> localtouch(The_Cpu_Arena()), remotetouch(The_Cpu_Arena());
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+        for (int i = 0; i < nlocal; ++i)
+        {
+	    const int   krcv = imap[i];
+	    const Box& vbx   = ba[krcv];
+	    const Box& bxrcv = amrex::grow(vbx, ng);
+
+            // keep checking thread safety if it is safe so far
+            const bool chk_local = check_local && threadsafe_loc;
+            const bool chk_remote = check_remote && threadsafe_rcv;
 	
-	if (check_remote) {
-	    remotetouch.resize(bxrcv);
-	    remotetouch.setVal<RunOn::Host>(0);
-	}
+	    if (chk_local) {
+	        localtouch.resize(bxrcv);
+	        localtouch.setVal<RunOn::Host>(0);
+	    }
 	
-	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
-	{
-	    ba.intersections(bxrcv+(*pit), isects);
-
-	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    if (chk_remote) {
+	        remotetouch.resize(bxrcv);
+	        remotetouch.setVal<RunOn::Host>(0);
+	    }
+	
+	    for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
 	    {
-		const int ksnd      = isects[j].first;
-		const Box& dst_bx   = isects[j].second - *pit;
-		const int src_owner = dm[ksnd];
+	        boxes.intersections(bxrcv+(*pit), isects, false, IntVect::TheZeroVector());
+
+	        for (int j = 0, M = isects.size(); j < M; ++j)
+	        {
+		    const int ksnd      = isects[j].first;
+		    const Box& dst_bx   = isects[j].second - *pit;
+		    const int src_owner = dm[ksnd];
 		
-		const BoxList& bl = amrex::boxDiff(dst_bx, vbx);
-		for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
-		{
-		    const Box& blbx = *lit;
+		    const BoxList& bl = amrex::boxDiff(dst_bx, vbx);
+		    for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+		    {
+		        const Box& blbx = *lit;
 			
-		    if (ParallelDescriptor::sameTeam(src_owner)) { // local copy
-			const BoxList tilelist(blbx, FabArrayBase::comm_tile_size);
-			for (BoxList::const_iterator
-				 it_tile  = tilelist.begin(),
-				 End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
-			{
-			    m_LocTags->push_back(CopyComTag(*it_tile, (*it_tile)+(*pit), krcv, ksnd));
-			}
-			if (check_local) {
-			    localtouch.plus<RunOn::Host>(1, blbx);
-			}
-		    } else if (MyProc == dm[krcv]) {
-			recv_tags[src_owner].push_back(CopyComTag(blbx, blbx+(*pit), krcv, ksnd));
-			if (check_remote) {
-			    remotetouch.plus<RunOn::Host>(1, blbx);
-			}
+		        if (ParallelDescriptor::sameTeam(src_owner)) { // local copy
+			    const BoxList tilelist(blbx, FabArrayBase::comm_tile_size);
+			    for (BoxList::const_iterator
+				     it_tile  = tilelist.begin(),
+				     End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
+			    {
+			        loc_tags[i].push_back(CopyComTag(*it_tile, (*it_tile)+(*pit), krcv, ksnd));
+			    }
+			    if (chk_local) {
+			        localtouch.plus<RunOn::Host>(1, blbx);
+			    }
+		        } else if (MyProc == dm[krcv]) {
+			    recv_tags[src_owner].push_back(CopyComTag(blbx, blbx+(*pit), krcv, ksnd));
+			    if (chk_remote) {
+			        remotetouch.plus<RunOn::Host>(1, blbx);
+			    }
+		        }
 		    }
-		}
+	        }
 	    }
-	}
 
-	if (check_local) {  
-	    // safe if a cell is touched no more than once 
-	    // keep checking thread safety if it is safe so far
-	    check_local = m_threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
-	}
+	    if (chk_local) {  
+	        // safe if a cell is touched no more than once 
+	        threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
+	    }
 
-	if (check_remote) {
-	    check_remote = m_threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
-	}
+	    if (chk_remote) {
+	        threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
+	    }
+        }
+
+#ifdef _OPENMP
+#pragma omp critical(fb_define_merge)
+#endif
+        {
+            merge_comm_tags(*m_SndTags, send_tags);
+            merge_comm_tags(*m_RcvTags, recv_tags);
+        }
+    }
+
+    for (auto& v : loc_tags) {
+        m_LocTags->insert(m_LocTags->end(), v.begin(), v.end());
+    }
+
+    if (check_local) {
+        m_threadsafe_loc = threadsafe_loc;
+    }
+
+    if (check_remote) {
+        m_threadsafe_rcv = threadsafe_rcv;
     }
 
     for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
@@ -981,100 +1811,796 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 	    }
 	}
 
-	if (check_local) {  
-	    // safe if a cell is touched no more than once 
-	    // keep checking thread safety if it is safe so far
-	    check_local = m_threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
+	if (check_local) {  
+	    // safe if a cell is touched no more than once 
+	    // keep checking thread safety if it is safe so far
+	    check_local = m_threadsafe_loc = localtouch.max<RunOn::Host>() <= 1;
+	}
+
+	if (check_remote) {
+	    check_remote = m_threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
+	}
+    }
+
+    for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
+    {
+	CopyComTag::MapOfCopyComTagContainers & Tags = (ipass == 0) ? *m_SndTags : *m_RcvTags;
+        for (auto& kv : Tags)
+	{
+	    std::vector<CopyComTag>& cctv = kv.second;
+	    // We need to fix the order so that the send and recv processes match.
+	    std::sort(cctv.begin(), cctv.end());
+	}
+    }
+}
+
+FabArrayBase::FB::~FB ()
+{
+    // The plans may refer to the graph communicator.
+    m_persistent_plans.clear();
+#if defined(BL_USE_MPI3)
+    // Collective over the processes of the parent communicator, so FBs
+    // are deleted in the order of m_coll_seq.
+    if (m_nbr_comm != MPI_COMM_NULL) MPI_Comm_free(&m_nbr_comm);
+#endif
+}
+
+MPI_Comm
+FabArrayBase::FB::getNeighborComm () const
+{
+#if defined(BL_USE_MPI3)
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+
+    if (m_nbr_comm == MPI_COMM_NULL)
+    {
+        BL_PROFILE("FabArrayBase::FB::getNeighborComm()");
+
+        // The weights are the numbers of points in the messages.
+        auto neighbors = [] (MapOfCopyComTagContainers const& tags, bool is_src,
+                             Vector<int>& ranks, Vector<int>& weights)
+        {
+            for (auto const& kv : tags) {
+                ranks.push_back(ParallelContext::global_to_local_rank(kv.first));
+                Long npts = 0;
+                for (auto const& cct : kv.second) {
+                    npts += is_src ? cct.dbox.numPts() : cct.sbox.numPts();
+                }
+                weights.push_back(static_cast<int>(std::min(npts,
+                                      static_cast<Long>(std::numeric_limits<int>::max()))));
+            }
+        };
+
+        Vector<int> sources, sourceweights, destinations, destweights;
+        neighbors(*m_RcvTags, true, sources, sourceweights);
+        neighbors(*m_SndTags, false, destinations, destweights);
+
+        // Keep the ranks (reorder = 0) so that the process owns the same data.
+        BL_MPI_REQUIRE( MPI_Dist_graph_create_adjacent
+                        (comm,
+                         sources.size(), sources.data(),
+                         sources.empty() ? MPI_WEIGHTS_EMPTY : sourceweights.data(),
+                         destinations.size(), destinations.data(),
+                         destinations.empty() ? MPI_WEIGHTS_EMPTY : destweights.data(),
+                         MPI_INFO_NULL, 0, &m_nbr_comm) );
+        m_nbr_parent = comm;
+        recordCollective();
+    }
+
+    return (m_nbr_parent == comm) ? m_nbr_comm : MPI_COMM_NULL;
+#else
+    return MPI_COMM_NULL;
+#endif
+}
+
+bool
+FabArrayBase::FB::isEvictable () const
+{
+    // Persistent plans and graph communicators are created and freed
+    // collectively.
+    return m_persistent_plans.empty() && m_nbr_comm == MPI_COMM_NULL;
+}
+
+void
+FabArrayBase::flushFB (bool no_assertion) const
+{
+    BL_ASSERT(no_assertion || getBDKey() == m_bdkey);
+    std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
+    for (FBCacheIter it = er_it.first; it != er_it.second; ++it)
+    {
+	m_FBC_stats.bytes -= it->second->bytes();
+	m_FBC_stats.plan_bytes -= it->second->planBytes();
+	m_FBC_stats.recordErase(it->second->m_nuse);
+	delete it->second;
+    }
+    m_TheFBCache.erase(er_it.first, er_it.second);
+}
+
+void
+FabArrayBase::FB::recordCollective () const
+{
+    if (m_coll_seq < 0) m_coll_seq = the_fb_coll_seq++;
+}
+
+void
+FabArrayBase::flushFBCache ()
+{
+    // The cache is ordered by pointers, which differ between processes.
+    // The FBs that free resources collectively are deleted in the order
+    // they created them, which is the same on all processes.
+    Vector<FB*> fbs;
+    fbs.reserve(m_TheFBCache.size());
+    for (FBCacheIter it = m_TheFBCache.begin(); it != m_TheFBCache.end(); ++it)
+    {
+	m_FBC_stats.recordErase(it->second->m_nuse);
+        fbs.push_back(it->second);
+    }
+    std::sort(fbs.begin(), fbs.end(),
+              [] (FB const* a, FB const* b) { return a->m_coll_seq < b->m_coll_seq; });
+    for (FB* fb : fbs) {
+        delete fb;
+    }
+    m_TheFBCache.clear();
+    m_FBC_stats.bytes = 0L;
+    m_FBC_stats.plan_bytes = 0L;
+}
+
+void
+FabArrayBase::trimFBCache (const BDKey& keep)
+{
+    if (fb_cache_max_bytes < 0 || m_no_cache_eviction > 0) return;
+
+    while (m_FBC_stats.bytes > fb_cache_max_bytes)
+    {
+        FBCacheIter victim = m_TheFBCache.end();
+        for (FBCacheIter it = m_TheFBCache.begin(); it != m_TheFBCache.end(); ++it)
+        {
+            if (it->first != keep && it->second->isEvictable() &&
+                (victim == m_TheFBCache.end() ||
+                 it->second->m_last_use < victim->second->m_last_use))
+            {
+                victim = it;
+            }
+        }
+        if (victim == m_TheFBCache.end()) break;
+
+        m_FBC_stats.bytes -= victim->second->bytes();
+        m_FBC_stats.recordEvict(victim->second->m_nuse);
+        delete victim->second;
+        m_TheFBCache.erase(victim);
+    }
+}
+
+const FabArrayBase::FB&
+FabArrayBase::getFB (const IntVect& nghost, const Periodicity& period,
+                     bool cross, bool enforce_periodicity_only) const
+{
+    BL_PROFILE("FabArrayBase::getFB()");
+
+    BL_ASSERT(getBDKey() == m_bdkey);
+    std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
+    for (FBCacheIter it = er_it.first; it != er_it.second; ++it)
+    {
+	if (it->second->m_typ        == boxArray().ixType()      &&
+            it->second->m_crse_ratio == boxArray().crseRatio()   &&
+	    it->second->m_ngrow      == nghost                   &&
+	    it->second->m_cross      == cross                    &&
+	    it->second->m_epo        == enforce_periodicity_only &&
+	    it->second->m_period     == period              )
+	{
+	    ++(it->second->m_nuse);
+	    it->second->m_last_use = ++m_cache_clock;
+	    m_FBC_stats.recordHit();
+	    return *(it->second);
+	}
+    }
+
+    // Have to build a new one
+    FB* new_fb = new FB(*this, nghost, cross, period, enforce_periodicity_only);
+
+    m_FBC_stats.recordBytes(new_fb->bytes());
+
+    new_fb->m_nuse = 1;
+    new_fb->m_last_use = ++m_cache_clock;
+    m_FBC_stats.recordBuild();
+    m_FBC_stats.recordUse();
+
+    m_TheFBCache.insert(er_it.second, FBCache::value_type(m_bdkey,new_fb));
+
+    trimFBCache(m_bdkey);
+
+    return *new_fb;
+}
+
+namespace {
+
+    // The same conditions as in FB::define_fb and CPC::define.
+    void comm_thread_safety_checks (bool& check_local, bool& check_remote)
+    {
+        check_local = false;
+        check_remote = false;
+#if defined(_OPENMP)
+        if (omp_get_max_threads() > 1) {
+            check_local = true;
+            check_remote = true;
+        }
+#elif defined(AMREX_USE_GPU)
+        check_local = true;
+        check_remote = true;
+#endif
+        if (ParallelDescriptor::TeamSize() > 1) {
+            check_local = true;
+        }
+    }
+
+    // Are the cells of each destination box touched no more than once?
+    bool touched_at_most_once (std::vector<const FabArrayBase::CopyComTag*>& tags)
+    {
+        std::sort(tags.begin(), tags.end(),
+                  [] (const FabArrayBase::CopyComTag* a, const FabArrayBase::CopyComTag* b)
+                  { return a->dstIndex < b->dstIndex; });
+
+        BaseFab<int> touch(The_Cpu_Arena());
+        for (std::size_t i = 0, N = tags.size(); i < N; )
+        {
+            std::size_t j = i;
+            Box bx = tags[i]->dbox;
+            for (; j < N && tags[j]->dstIndex == tags[i]->dstIndex; ++j) {
+                bx.minBox(tags[j]->dbox);
+            }
+            touch.resize(bx);
+            touch.setVal<RunOn::Host>(0);
+            for (std::size_t k = i; k < j; ++k) {
+                touch.plus<RunOn::Host>(1, tags[k]->dbox);
+            }
+            if (touch.max<RunOn::Host>() > 1) return false;
+            i = j;
+        }
+        return true;
+    }
+
+    // Keep the tags of old_md between boxes that have not changed.
+    void keep_comm_tags (FabArrayBase::CommMetaData& md, const FabArrayBase::CommMetaData& old_md,
+                         const Vector<int>& dst_old2new, const Vector<int>& src_old2new)
+    {
+        for (auto const& tag : *old_md.m_LocTags)
+        {
+            const int kdst = dst_old2new[tag.dstIndex];
+            const int ksrc = src_old2new[tag.srcIndex];
+            if (kdst >= 0 && ksrc >= 0) {
+                md.m_LocTags->push_back(FabArrayBase::CopyComTag(tag.dbox, tag.sbox, kdst, ksrc));
+            }
+        }
+
+        for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
+        {
+            const auto& old_tags = (ipass == 0) ? *old_md.m_SndTags : *old_md.m_RcvTags;
+            auto& tags = (ipass == 0) ? *md.m_SndTags : *md.m_RcvTags;
+            for (auto const& kv : old_tags)
+            {
+                for (auto const& tag : kv.second)
+                {
+                    const int kdst = dst_old2new[tag.dstIndex];
+                    const int ksrc = src_old2new[tag.srcIndex];
+                    if (kdst >= 0 && ksrc >= 0) {
+                        tags[kv.first].push_back(FabArrayBase::CopyComTag(tag.dbox, tag.sbox, kdst, ksrc));
+                    }
+                }
+            }
+        }
+    }
+
+    // Put the tags in the order of a full build and set the thread safety
+    // flags.  Only the destination boxes with new tags need to be checked
+    // if the old metadata were thread safe.
+    void finish_comm_tags (FabArrayBase::CommMetaData& md, const FabArrayBase::CommMetaData& old_md,
+                           const Vector<char>& dst_touched)
+    {
+        for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
+        {
+            auto& Tags = (ipass == 0) ? *md.m_SndTags : *md.m_RcvTags;
+            for (auto& kv : Tags)
+            {
+                // We need to fix the order so that the send and recv processes match.
+                std::sort(kv.second.begin(), kv.second.end());
+            }
+        }
+
+        std::stable_sort(md.m_LocTags->begin(), md.m_LocTags->end(),
+                         [] (const FabArrayBase::CopyComTag& a, const FabArrayBase::CopyComTag& b)
+                         { return a.dstIndex < b.dstIndex; });
+
+        bool check_local, check_remote;
+        comm_thread_safety_checks(check_local, check_remote);
+
+        md.m_threadsafe_loc = not check_local;
+        md.m_threadsafe_rcv = not check_remote;
+
+        std::vector<const FabArrayBase::CopyComTag*> tags;
+        if (check_local) {
+            for (auto const& tag : *md.m_LocTags) {
+                if (!old_md.m_threadsafe_loc || dst_touched[tag.dstIndex]) {
+                    tags.push_back(&tag);
+                }
+            }
+            md.m_threadsafe_loc = touched_at_most_once(tags);
+        }
+
+        if (check_remote) {
+            tags.clear();
+            for (auto const& kv : *md.m_RcvTags) {
+                for (auto const& tag : kv.second) {
+                    if (!old_md.m_threadsafe_rcv || dst_touched[tag.dstIndex]) {
+                        tags.push_back(&tag);
+                    }
+                }
+            }
+            md.m_threadsafe_rcv = touched_at_most_once(tags);
+        }
+    }
+}
+
+bool
+FabArrayBase::IndexDelta::define (const BoxArray& old_ba, const DistributionMapping& old_dm,
+                                  const BoxArray& new_ba, const DistributionMapping& new_dm)
+{
+    const int nold = old_ba.size();
+    const int nnew = new_ba.size();
+
+    std::map<Box,int> old_index;
+    for (int i = 0; i < nold; ++i) {
+        if (!old_index.emplace(old_ba[i], i).second) {
+            return false;
+        }
+    }
+
+    old2new.assign(nold, -1);
+    is_new.assign(nnew, 0);
+    new_boxes.clear();
+
+    for (int k = 0; k < nnew; ++k)
+    {
+        auto it = old_index.find(new_ba[k]);
+        if (it != old_index.end() && old2new[it->second] < 0 && old_dm[it->second] == new_dm[k]) {
+            old2new[it->second] = k;
+        } else {
+            new_boxes.push_back(k);
+            is_new[k] = 1;
+        }
+    }
+
+    return true;
+}
+
+void
+FabArrayBase::IndexDelta::setIdentity (int nboxes)
+{
+    old2new.resize(nboxes);
+    std::iota(old2new.begin(), old2new.end(), 0);
+    is_new.assign(nboxes, 0);
+    new_boxes.clear();
+}
+
+FabArrayBase::FB::FB (const FabArrayBase& fa, const FB& old_fb, const IndexDelta& delta)
+    : m_typ(old_fb.m_typ), m_crse_ratio(old_fb.m_crse_ratio),
+      m_ngrow(old_fb.m_ngrow), m_cross(false),
+      m_epo(false), m_period(old_fb.m_period),
+      m_nuse(0)
+{
+    BL_PROFILE("FabArrayBase::FB::FB(patch)");
+
+    BL_ASSERT(!old_fb.m_cross && !old_fb.m_epo);
+
+    m_LocTags.reset(new CopyComTag::CopyComTagsContainer);
+    m_SndTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+    m_RcvTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+
+    if (!fa.IndexArray().empty()) {
+        define_patch(fa, old_fb, delta);
+    }
+}
+
+void
+FabArrayBase::FB::define_patch (const FabArrayBase& fa, const FB& old_fb, const IndexDelta& delta)
+{
+    // The tags of a (receiver, sender) pair depend only on the two boxes
+    // and their owners.  So we keep the old tags between unchanged boxes,
+    // and compute the ones involving a new box like define_fb does.
+
+    const int                  MyProc   = ParallelDescriptor::MyProc();
+    const BoxArray&            ba       = fa.boxArray();
+    const DistributionMapping& dm       = fa.DistributionMap();
+    const Vector<int>&         newboxes = delta.new_boxes;
+    const Vector<char>&        is_new   = delta.is_new;
+
+    const IntVect& ng = m_ngrow;
+    std::vector< std::pair<int,Box> > isects;
+
+    const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+
+    keep_comm_tags(*this, old_fb, delta.old2new, delta.old2new);
+
+    auto& send_tags = *m_SndTags;
+
+    auto add_send = [&] (int krcv, int ksnd, const Box& bx, const IntVect& shift)
+    {
+        const BoxList& bl = amrex::boxDiff(bx, ba[krcv]);
+        for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+            send_tags[dm[krcv]].push_back(CopyComTag(*lit, (*lit)-shift, krcv, ksnd));
+    };
+
+    // New local senders
+    for (int ksnd : newboxes)
+    {
+        if (MyProc != dm[ksnd]) continue;
+
+	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+	{
+	    ba.intersections(ba[ksnd]+(*pit), isects, false, ng);
+
+	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    {
+		const int krcv = isects[j].first;
+		if (!ParallelDescriptor::sameTeam(dm[krcv])) {
+                    add_send(krcv, ksnd, isects[j].second, *pit);
+                }
+	    }
+	}
+    }
+
+    // Old local senders to new receivers
+    for (int krcv : newboxes)
+    {
+        if (ParallelDescriptor::sameTeam(dm[krcv])) continue;
+
+        const Box& bxrcv = amrex::grow(ba[krcv], ng);
+
+	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+	{
+	    ba.intersections(bxrcv-(*pit), isects);
+
+	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    {
+		const int ksnd = isects[j].first;
+		if (!is_new[ksnd] && MyProc == dm[ksnd]) {
+                    add_send(krcv, ksnd, isects[j].second+(*pit), *pit);
+                }
+	    }
 	}
+    }
 
-	if (check_remote) {
-	    check_remote = m_threadsafe_rcv = remotetouch.max<RunOn::Host>() <= 1;
+    auto& recv_tags = *m_RcvTags;
+
+    Vector<char> touched(ba.size(), 0);
+
+    auto add_recv = [&] (int krcv, int ksnd, const Box& dst_bx, const IntVect& shift)
+    {
+        const int src_owner = dm[ksnd];
+        const BoxList& bl = amrex::boxDiff(dst_bx, ba[krcv]);
+        for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+        {
+            const Box& blbx = *lit;
+
+            if (ParallelDescriptor::sameTeam(src_owner)) { // local copy
+                const BoxList tilelist(blbx, FabArrayBase::comm_tile_size);
+                for (BoxList::const_iterator
+                         it_tile  = tilelist.begin(),
+                         End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
+                {
+                    m_LocTags->push_back(CopyComTag(*it_tile, (*it_tile)+shift, krcv, ksnd));
+                }
+                touched[krcv] = 1;
+            } else if (MyProc == dm[krcv]) {
+                recv_tags[src_owner].push_back(CopyComTag(blbx, blbx+shift, krcv, ksnd));
+                touched[krcv] = 1;
+            }
+        }
+    };
+
+    // New local receivers
+    for (int krcv : newboxes)
+    {
+        if (!ParallelDescriptor::sameTeam(dm[krcv])) continue;
+
+        const Box& bxrcv = amrex::grow(ba[krcv], ng);
+
+	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+	{
+	    ba.intersections(bxrcv+(*pit), isects);
+
+	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    {
+                add_recv(krcv, isects[j].first, isects[j].second - *pit, *pit);
+	    }
 	}
     }
 
-    for (int ipass = 0; ipass < 2; ++ipass) // pass 0: send; pass 1: recv
+    // Old local receivers from new senders
+    for (int ksnd : newboxes)
     {
-	CopyComTag::MapOfCopyComTagContainers & Tags = (ipass == 0) ? *m_SndTags : *m_RcvTags;
-        for (auto& kv : Tags)
+	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
 	{
-	    std::vector<CopyComTag>& cctv = kv.second;
-	    // We need to fix the order so that the send and recv processes match.
-	    std::sort(cctv.begin(), cctv.end());
+	    ba.intersections(ba[ksnd]-(*pit), isects, false, ng);
+
+	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    {
+		const int krcv = isects[j].first;
+                if (!is_new[krcv] && ParallelDescriptor::sameTeam(dm[krcv])) {
+                    add_recv(krcv, ksnd, isects[j].second, *pit);
+                }
+	    }
 	}
     }
-}
 
-FabArrayBase::FB::~FB ()
-{}
+    finish_comm_tags(*this, old_fb, touched);
+}
 
-void
-FabArrayBase::flushFB (bool no_assertion) const
+FabArrayBase::CPC::CPC (const CPC& old_cpc,
+                        const BoxArray& dstba, const DistributionMapping& dstdm, const IndexDelta& dstdelta,
+                        const BoxArray& srcba, const DistributionMapping& srcdm, const IndexDelta& srcdelta)
+    : m_srcbdk(), 
+      m_dstbdk(), 
+      m_srcng(old_cpc.m_srcng), 
+      m_dstng(old_cpc.m_dstng), 
+      m_period(old_cpc.m_period),
+      m_srcba(srcba), 
+      m_dstba(dstba),
+      m_srcdm(srcdm),
+      m_dstdm(dstdm),
+      m_nuse(0)
 {
-    BL_ASSERT(no_assertion || getBDKey() == m_bdkey);
-    std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
-    for (FBCacheIter it = er_it.first; it != er_it.second; ++it)
+    BL_PROFILE("FabArrayBase::CPC::CPC(patch)");
+
+    // See FB::define_patch.  Either side may have changed.
+
+    m_LocTags.reset(new CopyComTag::CopyComTagsContainer);
+    m_SndTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+    m_RcvTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+
+    if (m_dstdm.getIndexArray().empty() && m_srcdm.getIndexArray().empty()) return;
+
+    const int MyProc = ParallelDescriptor::MyProc();
+    const BoxArray& ba_dst = m_dstba;
+    const BoxArray& ba_src = m_srcba;
+    const DistributionMapping& dm_dst = m_dstdm;
+    const DistributionMapping& dm_src = m_srcdm;
+    const IntVect& ng_src = m_srcng;
+    const IntVect& ng_dst = m_dstng;
+
+    std::vector< std::pair<int,Box> > isects;
+
+    const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+
+    keep_comm_tags(*this, old_cpc, dstdelta.old2new, srcdelta.old2new);
+
+    auto& send_tags = *m_SndTags;
+
+    // New local sources
+    for (int k_src : srcdelta.new_boxes)
     {
-#ifdef AMREX_MEM_PROFILING
-	m_FBC_stats.bytes -= it->second->bytes();
-#endif
-	m_FBC_stats.recordErase(it->second->m_nuse);
-	delete it->second;
+        if (MyProc != dm_src[k_src]) continue;
+
+        const Box& bx_src = amrex::grow(ba_src[k_src], ng_src);
+
+        for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+        {
+            ba_dst.intersections(bx_src+(*pit), isects, false, ng_dst);
+
+            for (int j = 0, M = isects.size(); j < M; ++j)
+            {
+                const int k_dst     = isects[j].first;
+                const Box& bx       = isects[j].second;
+                const int dst_owner = dm_dst[k_dst];
+                if (!ParallelDescriptor::sameTeam(dst_owner)) {
+                    send_tags[dst_owner].push_back(CopyComTag(bx, bx-(*pit), k_dst, k_src));
+                }
+            }
+        }
     }
-    m_TheFBCache.erase(er_it.first, er_it.second);
-}
 
-void
-FabArrayBase::flushFBCache ()
-{
-    for (FBCacheIter it = m_TheFBCache.begin(); it != m_TheFBCache.end(); ++it)
+    // Old local sources to new destinations
+    for (int k_dst : dstdelta.new_boxes)
     {
-	m_FBC_stats.recordErase(it->second->m_nuse);
-	delete it->second;
+        const int dst_owner = dm_dst[k_dst];
+        if (ParallelDescriptor::sameTeam(dst_owner)) continue;
+
+        const Box& bx_dst = amrex::grow(ba_dst[k_dst], ng_dst);
+
+        for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+        {
+            ba_src.intersections(bx_dst-(*pit), isects, false, ng_src);
+
+            for (int j = 0, M = isects.size(); j < M; ++j)
+            {
+                const int k_src = isects[j].first;
+                if (!srcdelta.is_new[k_src] && MyProc == dm_src[k_src]) {
+                    const Box& bx = isects[j].second + (*pit);
+                    send_tags[dst_owner].push_back(CopyComTag(bx, bx-(*pit), k_dst, k_src));
+                }
+            }
+        }
     }
-    m_TheFBCache.clear();
-#ifdef AMREX_MEM_PROFILING
-    m_FBC_stats.bytes = 0L;
-#endif
+
+    auto& recv_tags = *m_RcvTags;
+
+    Vector<char> touched(ba_dst.size(), 0);
+
+    auto add_recv = [&] (int k_dst, int k_src, const Box& bx, const IntVect& shift)
+    {
+        const int src_owner = dm_src[k_src];
+        if (ParallelDescriptor::sameTeam(src_owner, MyProc)) { // local copy
+            const BoxList tilelist(bx, FabArrayBase::comm_tile_size);
+            for (BoxList::const_iterator
+                     it_tile  = tilelist.begin(),
+                     End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
+            {
+                m_LocTags->push_back(CopyComTag(*it_tile, (*it_tile)+shift, k_dst, k_src));
+            }
+            touched[k_dst] = 1;
+        } else if (MyProc == dm_dst[k_dst]) {
+            recv_tags[src_owner].push_back(CopyComTag(bx, bx+shift, k_dst, k_src));
+            touched[k_dst] = 1;
+        }
+    };
+
+    // New local destinations
+    for (int k_dst : dstdelta.new_boxes)
+    {
+        if (!ParallelDescriptor::sameTeam(dm_dst[k_dst])) continue;
+
+        const Box& bx_dst = amrex::grow(ba_dst[k_dst], ng_dst);
+
+        for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+        {
+            ba_src.intersections(bx_dst+(*pit), isects, false, ng_src);
+
+            for (int j = 0, M = isects.size(); j < M; ++j)
+            {
+                add_recv(k_dst, isects[j].first, isects[j].second - *pit, *pit);
+            }
+        }
+    }
+
+    // Old local destinations from new sources
+    for (int k_src : srcdelta.new_boxes)
+    {
+        const Box& bx_src = amrex::grow(ba_src[k_src], ng_src);
+
+        for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
+        {
+            ba_dst.intersections(bx_src-(*pit), isects, false, ng_dst);
+
+            for (int j = 0, M = isects.size(); j < M; ++j)
+            {
+                const int k_dst = isects[j].first;
+                if (!dstdelta.is_new[k_dst] && ParallelDescriptor::sameTeam(dm_dst[k_dst])) {
+                    add_recv(k_dst, k_src, isects[j].second, *pit);
+                }
+            }
+        }
+    }
+
+    finish_comm_tags(*this, old_cpc, touched);
 }
 
-const FabArrayBase::FB&
-FabArrayBase::getFB (const IntVect& nghost, const Periodicity& period,
-                     bool cross, bool enforce_periodicity_only) const
+void
+FabArrayBase::patchCommMetaData (const FabArrayBase& old_fa) const
 {
-    BL_PROFILE("FabArrayBase::getFB()");
+    BL_PROFILE("FabArrayBase::patchCommMetaData()");
 
     BL_ASSERT(getBDKey() == m_bdkey);
-    std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
-    for (FBCacheIter it = er_it.first; it != er_it.second; ++it)
-    {
-	if (it->second->m_typ        == boxArray().ixType()      &&
-            it->second->m_crse_ratio == boxArray().crseRatio()   &&
-	    it->second->m_ngrow      == nghost                   &&
-	    it->second->m_cross      == cross                    &&
-	    it->second->m_epo        == enforce_periodicity_only &&
-	    it->second->m_period     == period              )
-	{
-	    ++(it->second->m_nuse);
-	    m_FBC_stats.recordUse();
-	    return *(it->second);
-	}
+    BL_ASSERT(old_fa.getBDKey() == old_fa.m_bdkey);
+
+    const BDKey& oldkey = old_fa.m_bdkey;
+    const BoxArray& ba = boxArray();
+    const BoxArray& old_ba = old_fa.boxArray();
+
+    if (oldkey == m_bdkey || ba.empty() || old_ba.empty() ||
+        ba.ixType() != old_ba.ixType() || ba.crseRatio() != old_ba.crseRatio()) {
+        return;
     }
 
-    // Have to build a new one
-    FB* new_fb = new FB(*this, nghost, cross, period, enforce_periodicity_only);
+    IndexDelta delta;
+    if (!delta.define(old_ba, old_fa.DistributionMap(), ba, DistributionMap())) {
+        return;
+    }
 
-#ifdef BL_PROFILE
-    m_FBC_stats.bytes += new_fb->bytes();
-    m_FBC_stats.bytes_hwm = std::max(m_FBC_stats.bytes_hwm, m_FBC_stats.bytes);
-#endif
+    // It is cheaper to build from scratch if most of the boxes have changed.
+    if (2*static_cast<Long>(delta.new_boxes.size()) > ba.size()) {
+        return;
+    }
 
-    new_fb->m_nuse = 1;
-    m_FBC_stats.recordBuild();
-    m_FBC_stats.recordUse();
+    {
+        NoCacheEviction no_eviction;
 
-    m_TheFBCache.insert(er_it.second, FBCache::value_type(m_bdkey,new_fb));
+        std::vector<const FB*> old_fbs;
+        {
+            auto er_it = m_TheFBCache.equal_range(oldkey);
+            for (auto it = er_it.first; it != er_it.second; ++it) {
+                if (!it->second->m_cross && !it->second->m_epo) {
+                    old_fbs.push_back(it->second);
+                }
+            }
+        }
 
-    return *new_fb;
+        for (const FB* old_fb : old_fbs)
+        {
+            bool found = false;
+            auto er_it = m_TheFBCache.equal_range(m_bdkey);
+            for (auto it = er_it.first; it != er_it.second && !found; ++it) {
+                found = it->second->m_typ        == old_fb->m_typ
+                    &&  it->second->m_crse_ratio == old_fb->m_crse_ratio
+                    &&  it->second->m_ngrow      == old_fb->m_ngrow
+                    && !it->second->m_cross
+                    && !it->second->m_epo
+                    &&  it->second->m_period     == old_fb->m_period;
+            }
+            if (found) continue;
+
+            FB* new_fb = new FB(*this, *old_fb, delta);
+
+            m_FBC_stats.recordBytes(new_fb->bytes());
+
+            new_fb->m_last_use = ++m_cache_clock;
+            m_FBC_stats.recordPatch();
+
+            m_TheFBCache.insert(er_it.second, FBCache::value_type(m_bdkey,new_fb));
+        }
+
+        std::vector<const CPC*> old_cpcs;
+        {
+            auto er_it = m_TheCPCache.equal_range(oldkey);
+            for (auto it = er_it.first; it != er_it.second; ++it) {
+                old_cpcs.push_back(it->second);
+            }
+        }
+
+        for (const CPC* old_cpc : old_cpcs)
+        {
+            const bool dst_changed = old_cpc->m_dstbdk == oldkey;
+            const bool src_changed = old_cpc->m_srcbdk == oldkey;
+
+            const BDKey dstkey = dst_changed ? m_bdkey : old_cpc->m_dstbdk;
+            const BDKey srckey = src_changed ? m_bdkey : old_cpc->m_srcbdk;
+
+            bool found = false;
+            auto er_it = m_TheCPCache.equal_range(dstkey);
+            for (auto it = er_it.first; it != er_it.second && !found; ++it) {
+                found = it->second->m_srcng  == old_cpc->m_srcng
+                    &&  it->second->m_dstng  == old_cpc->m_dstng
+                    &&  it->second->m_srcbdk == srckey
+                    &&  it->second->m_dstbdk == dstkey
+                    &&  it->second->m_period == old_cpc->m_period;
+            }
+            if (found) continue;
+
+            IndexDelta other;
+            if (!(dst_changed && src_changed)) {
+                other.setIdentity(dst_changed ? old_cpc->m_srcba.size() : old_cpc->m_dstba.size());
+            }
+
+            CPC* new_cpc = new CPC(*old_cpc,
+                                   dst_changed ? ba : old_cpc->m_dstba,
+                                   dst_changed ? DistributionMap() : old_cpc->m_dstdm,
+                                   dst_changed ? delta : other,
+                                   src_changed ? ba : old_cpc->m_srcba,
+                                   src_changed ? DistributionMap() : old_cpc->m_srcdm,
+                                   src_changed ? delta : other);
+            new_cpc->m_srcbdk = srckey;
+            new_cpc->m_dstbdk = dstkey;
+
+            m_CPC_stats.recordBytes(new_cpc->bytes());
+
+            new_cpc->m_last_use = ++m_cache_clock;
+            m_CPC_stats.recordPatch();
+
+            m_TheCPCache.insert(er_it.second, CPCache::value_type(dstkey,new_cpc));
+            if (srckey != dstkey)
+                m_TheCPCache.insert(          CPCache::value_type(srckey,new_cpc));
+        }
+    }
+
+    trimFBCache(m_bdkey);
+    trimCPCache(m_bdkey, m_bdkey);
 }
 
 FabArrayBase::FPinfo::FPinfo (const FabArrayBase& srcfa,
@@ -1349,7 +2875,8 @@ FabArrayBase::TheCFinfo (const FabArrayBase& finefa,
             it->second->m_ng          == ng)
         {
             ++(it->second->m_nuse);
-            m_CFinfo_stats.recordUse();
+            it->second->m_last_use = ++m_cache_clock;
+            m_CFinfo_stats.recordHit();
             return *(it->second);
         }
     }
@@ -1357,17 +2884,17 @@ FabArrayBase::TheCFinfo (const FabArrayBase& finefa,
     // Have to build a new one
     CFinfo* new_cfinfo = new CFinfo(finefa, finegm, ng, include_periodic, include_physbndry);
 
-#ifdef AMREX_MEM_PROFILING
-    m_CFinfo_stats.bytes += new_cfinfo->bytes();
-    m_CFinfo_stats.bytes_hwm = std::max(m_CFinfo_stats.bytes_hwm, m_CFinfo_stats.bytes);
-#endif
+    m_CFinfo_stats.recordBytes(new_cfinfo->bytes());
 
     new_cfinfo->m_nuse = 1;
+    new_cfinfo->m_last_use = ++m_cache_clock;
     m_CFinfo_stats.recordBuild();
     m_CFinfo_stats.recordUse();
 
     m_TheCrseFineCache.insert(er_it.second, CFinfoCache::value_type(key,new_cfinfo));
 
+    trimCFinfoCache(key);
+
     return *new_cfinfo;
 }
 
@@ -1378,15 +2905,50 @@ FabArrayBase::flushCFinfo (bool no_assertion)
     auto er_it = m_TheCrseFineCache.equal_range(m_bdkey);
     for (auto it = er_it.first; it != er_it.second; ++it)
     {
-#ifdef AMREX_MEM_PROFILING
         m_CFinfo_stats.bytes -= it->second->bytes();
-#endif
         m_CFinfo_stats.recordErase(it->second->m_nuse);
         delete it->second;
     }
     m_TheCrseFineCache.erase(er_it.first, er_it.second);
 }
 
+void
+FabArrayBase::trimCFinfoCache (const BDKey& keep)
+{
+    if (cfinfo_cache_max_bytes < 0 || m_no_cache_eviction > 0) return;
+
+    while (m_CFinfo_stats.bytes > cfinfo_cache_max_bytes)
+    {
+        auto victim = m_TheCrseFineCache.end();
+        for (auto it = m_TheCrseFineCache.begin(); it != m_TheCrseFineCache.end(); ++it)
+        {
+            if (it->first != keep &&
+                (victim == m_TheCrseFineCache.end() ||
+                 it->second->m_last_use < victim->second->m_last_use))
+            {
+                victim = it;
+            }
+        }
+        if (victim == m_TheCrseFineCache.end()) break;
+
+        m_CFinfo_stats.bytes -= victim->second->bytes();
+        m_CFinfo_stats.recordEvict(victim->second->m_nuse);
+        delete victim->second;
+        m_TheCrseFineCache.erase(victim);
+    }
+}
+
+void
+FabArrayBase::printCacheStats ()
+{
+    if (ParallelContext::IOProcessorSub())
+    {
+        m_FBC_stats.print();
+        m_CPC_stats.print();
+        m_CFinfo_stats.print();
+    }
+}
+
 void
 FabArrayBase::Finalize ()
 {
@@ -1394,6 +2956,11 @@ FabArrayBase::Finalize ()
     FabArrayBase::flushCPCache();
     FabArrayBase::flushTileArrayCache();
 
+#if defined(BL_USE_MPI3)
+    if (the_node_comm != MPI_COMM_NULL) MPI_Comm_free(&the_node_comm);
+#endif
+    the_fb_coll_seq = 0;
+
     if (ParallelDescriptor::IOProcessor() && amrex::system::verbose > 1) {
 	m_FA_stats.print();
 	m_TAC_stats.print();
@@ -1401,6 +2968,9 @@ FabArrayBase::Finalize ()
 	m_CPC_stats.print();
 	m_FPinfo_stats.print();
 	m_CFinfo_stats.print();
+        if (m_CommComp_stats.nmsgs + m_CommComp_stats.nraw > 0) {
+            m_CommComp_stats.print();
+        }
     }
 
     if (amrex::system::verbose > 1) {
@@ -1413,6 +2983,7 @@ FabArrayBase::Finalize ()
     m_CPC_stats = CacheStats("CopyCache");
     m_FPinfo_stats = CacheStats("FillPatchCache");
     m_CFinfo_stats = CacheStats("CrseFineCache");
+    m_CommComp_stats = CommCompressionStats();
 
     m_BD_count.clear();
     
@@ -1673,6 +3244,107 @@ FabArrayBase::WaitForAsyncSends (int                 N_snds,
 
 #ifdef BL_USE_MPI
 
+void
+FabArrayBase::NeighborCounts (char const* the_send_data, Vector<char*> const& send_data,
+                              Vector<std::size_t> const& send_size,
+                              char const* the_recv_data, Vector<char*> const& recv_data,
+                              Vector<std::size_t> const& recv_size,
+                              Vector<int>& counts)
+{
+    const int nsend = send_size.size();
+    const int nrecv = recv_size.size();
+    counts.assign(2*(nsend+nrecv), 0);
+
+    auto fill = [] (char const* the_data, Vector<char*> const& data,
+                    Vector<std::size_t> const& size, int* cnt, int* displ)
+    {
+        constexpr std::size_t imax = std::numeric_limits<int>::max();
+        for (int i = 0, N = size.size(); i < N; ++i) {
+            if (data[i] != nullptr) {
+                const std::size_t d = data[i] - the_data;
+                if (size[i] > imax || d > imax) {
+                    amrex::Abort("FabArray: message is too big for fabarray.use_neighbor_fb");
+                }
+                cnt[i] = static_cast<int>(size[i]);
+                displ[i] = static_cast<int>(d);
+            }
+        }
+    };
+
+    fill(the_send_data, send_data, send_size, counts.data(), counts.data()+nsend);
+    fill(the_recv_data, recv_data, recv_size, counts.data()+2*nsend, counts.data()+2*nsend+nrecv);
+}
+
+MPI_Request
+FabArrayBase::PostNeighborAlltoallv (char* the_send_data, Vector<char*> const& send_data,
+                                     Vector<std::size_t> const& send_size,
+                                     char* the_recv_data, Vector<char*> const& recv_data,
+                                     Vector<std::size_t> const& recv_size,
+                                     Vector<int>& counts, MPI_Comm nbr_comm)
+{
+    MPI_Request req = MPI_REQUEST_NULL;
+#if defined(BL_USE_MPI3)
+    NeighborCounts(the_send_data, send_data, send_size,
+                   the_recv_data, recv_data, recv_size, counts);
+    const int nsend = send_size.size();
+    const int nrecv = recv_size.size();
+    const MPI_Datatype chr = ParallelDescriptor::Mpi_typemap<char>::type();
+    const int* c = counts.data();
+    BL_MPI_REQUIRE( MPI_Ineighbor_alltoallv(the_send_data, c, c+nsend, chr,
+                                            the_recv_data, c+2*nsend, c+2*nsend+nrecv, chr,
+                                            nbr_comm, &req) );
+#else
+    amrex::ignore_unused(the_send_data, send_data, send_size, the_recv_data,
+                         recv_data, recv_size, counts, nbr_comm);
+    amrex::Abort("FabArray: fabarray.use_neighbor_fb requires MPI-3");
+#endif
+    return req;
+}
+
+MPI_Request
+FabArrayBase::PostSend (char* data, std::size_t nbytes, int global_rank,
+                        int tag, MPI_Comm comm)
+{
+    const int rank = ParallelContext::global_to_local_rank(global_rank);
+    const int comm_data_type = ParallelDescriptor::select_comm_data_type(nbytes);
+    if (comm_data_type == 1) {
+        return ParallelDescriptor::Asend(data, nbytes, rank, tag, comm).req();
+    } else if (comm_data_type == 2) {
+        return ParallelDescriptor::Asend((unsigned long long *)data,
+                                         nbytes/sizeof(unsigned long long),
+                                         rank, tag, comm).req();
+    } else if (comm_data_type == 3) {
+        return ParallelDescriptor::Asend((ParallelDescriptor::lull_t *)data,
+                                         nbytes/sizeof(ParallelDescriptor::lull_t),
+                                         rank, tag, comm).req();
+    } else {
+        amrex::Abort("TODO: message size is too big");
+        return MPI_REQUEST_NULL;
+    }
+}
+
+MPI_Request
+FabArrayBase::PostRecv (char* data, std::size_t nbytes, int global_rank,
+                        int tag, MPI_Comm comm)
+{
+    const int rank = ParallelContext::global_to_local_rank(global_rank);
+    const int comm_data_type = ParallelDescriptor::select_comm_data_type(nbytes);
+    if (comm_data_type == 1) {
+        return ParallelDescriptor::Arecv(data, nbytes, rank, tag, comm).req();
+    } else if (comm_data_type == 2) {
+        return ParallelDescriptor::Arecv((unsigned long long *)data,
+                                         nbytes/sizeof(unsigned long long),
+                                         rank, tag, comm).req();
+    } else if (comm_data_type == 3) {
+        return ParallelDescriptor::Arecv((ParallelDescriptor::lull_t *)data,
+                                         nbytes/sizeof(ParallelDescriptor::lull_t),
+                                         rank, tag, comm).req();
+    } else {
+        amrex::Abort("TODO: message size is too big");
+        return MPI_REQUEST_NULL;
+    }
+}
+
 bool
 FabArrayBase::CheckRcvStats(Vector<MPI_Status>& recv_stats,
 			    const Vector<std::size_t>& recv_size,
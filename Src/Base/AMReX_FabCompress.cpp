@@ -0,0 +1,255 @@
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#include <AMReX_FabCompress.H>
+#include <AMReX_FPC.H>
+#include <AMReX.H>
+
+namespace amrex {
+namespace FabCompress {
+
+namespace {
+
+    //! Quantized values must fit in the mantissa of a double.
+    constexpr double max_quantized = 4503599627370496.0;  // 2^52
+
+    /**
+    * PackBits: a control byte c < 128 is followed by c+1 literal bytes,
+    * a control byte c >= 128 by one byte to be repeated c-125 times.
+    * Returns the number of bytes written to out, which must hold at
+    * least n + n/128 + 1 bytes.
+    */
+    Long packBits (const unsigned char* in, Long n, unsigned char* out)
+    {
+        unsigned char* p = out;
+        Long i = 0;
+        while (i < n) {
+            Long r = 1;
+            while (i+r < n && r < 130 && in[i+r] == in[i]) ++r;
+            if (r >= 3) {
+                *p++ = static_cast<unsigned char>(r+125);
+                *p++ = in[i];
+                i += r;
+            } else {
+                Long j = i;
+                while (j < n && j-i < 128) {
+                    if (j+2 < n && in[j] == in[j+1] && in[j] == in[j+2]) break;
+                    ++j;
+                }
+                *p++ = static_cast<unsigned char>(j-i-1);
+                std::memcpy(p, in+i, j-i);
+                p += j-i;
+                i = j;
+            }
+        }
+        return p - out;
+    }
+
+    void unpackBits (const unsigned char* in, Long nbytes, unsigned char* out, Long n)
+    {
+        const unsigned char* end = in + nbytes;
+        Long i = 0;
+        while (i < n) {
+            if (in >= end) {
+                amrex::Abort("FabCompress::Decompress: truncated block");
+            }
+            const int c = *in++;
+            if (c < 128) {
+                const Long len = c+1;
+                if (i+len > n || in+len > end) {
+                    amrex::Abort("FabCompress::Decompress: corrupt block");
+                }
+                std::memcpy(out+i, in, len);
+                in += len;
+                i += len;
+            } else {
+                const Long len = c-125;
+                if (i+len > n || in >= end) {
+                    amrex::Abort("FabCompress::Decompress: corrupt block");
+                }
+                std::memset(out+i, *in++, len);
+                i += len;
+            }
+        }
+    }
+
+    //! Store a double as 8 little-endian bytes, independent of the host.
+    void putDouble (double d, unsigned char* p)
+    {
+        std::uint64_t u;
+        std::memcpy(&u, &d, sizeof(u));
+        for (int b = 0; b < 8; ++b) {
+            p[b] = static_cast<unsigned char>(u >> (8*b));
+        }
+    }
+
+    double getDouble (const unsigned char* p)
+    {
+        std::uint64_t u = 0;
+        for (int b = 0; b < 8; ++b) {
+            u |= static_cast<std::uint64_t>(p[b]) << (8*b);
+        }
+        double d;
+        std::memcpy(&d, &u, sizeof(d));
+        return d;
+    }
+
+    //! Append the PackBits encoding of planes to out after a block header.
+    Long appendBlock (const unsigned char* head, int nhead,
+                      const std::vector<unsigned char>& planes, Vector<char>& out)
+    {
+        const Long n = planes.size();
+        const std::size_t old_size = out.size();
+        out.resize(old_size + nhead + n + n/128 + 1);
+        auto p = reinterpret_cast<unsigned char*>(out.data() + old_size);
+        std::memcpy(p, head, nhead);
+        const Long nbytes = nhead + packBits(planes.data(), n, p+nhead);
+        out.resize(old_size + nbytes);
+        return nbytes;
+    }
+}
+
+Long
+Compress (const Real* in, Long n, const RealDescriptor& rd,
+          Real tolerance, Vector<char>& out)
+{
+    const int w = rd.numBytes();
+    const Long rawbytes = 1 + n*w;
+    const std::size_t old_size = out.size();
+
+    if (tolerance > 0 && n > 0)
+    {
+        const double step = 2.0*tolerance;
+        std::vector<unsigned char> planes(n*8);
+        bool ok = true;
+        std::int64_t prev = 0;
+        for (Long i = 0; i < n; ++i) {
+            const double q = std::nearbyint(static_cast<double>(in[i]) / step);
+            if ( ! (std::abs(q) < max_quantized)) {  // ---- also catches NaNs
+                ok = false;
+                break;
+            }
+            const auto qi = static_cast<std::int64_t>(q);
+            const std::int64_t d = qi - prev;
+            prev = qi;
+            // ---- zigzag encoding keeps small negative differences small
+            const std::uint64_t z = (static_cast<std::uint64_t>(d) << 1) ^
+                                    static_cast<std::uint64_t>(d >> 63);
+            for (int b = 0; b < 8; ++b) {
+                planes[b*n+i] = static_cast<unsigned char>(z >> (8*b));
+            }
+        }
+        if (ok) {
+            unsigned char head[9];
+            head[0] = Quantized;
+            putDouble(step, head+1);
+            const Long nbytes = appendBlock(head, 9, planes, out);
+            if (nbytes < rawbytes) {
+                return nbytes;
+            }
+            out.resize(old_size);
+        }
+    }
+
+    std::vector<unsigned char> bytes(n*w);
+    if (rd == FPC::NativeRealDescriptor()) {
+        std::memcpy(bytes.data(), in, n*w);
+    } else {
+        RealDescriptor::convertFromNativeFormat(bytes.data(), n, in, rd);
+    }
+
+    if (n > 0)
+    {
+        std::vector<unsigned char> planes(n*w);
+        for (int b = 0; b < w; ++b) {
+            unsigned char* pl = planes.data() + b*n;
+            pl[0] = bytes[b];
+            for (Long i = 1; i < n; ++i) {
+                pl[i] = bytes[i*w+b] ^ bytes[(i-1)*w+b];
+            }
+        }
+        unsigned char head[1] = { Lossless };
+        const Long nbytes = appendBlock(head, 1, planes, out);
+        if (nbytes < rawbytes) {
+            return nbytes;
+        }
+        out.resize(old_size);
+    }
+
+    out.resize(old_size + rawbytes);
+    out[old_size] = Raw;
+    std::memcpy(out.data() + old_size + 1, bytes.data(), n*w);
+    return rawbytes;
+}
+
+void
+Decompress (const char* in, Long nbytes, Real* out, Long n,
+            const RealDescriptor& rd)
+{
+    if (nbytes < 1) {
+        amrex::Abort("FabCompress::Decompress: empty block");
+    }
+    auto p = reinterpret_cast<const unsigned char*>(in);
+    const int method = p[0];
+    const int w = rd.numBytes();
+
+    if (method == Quantized)
+    {
+        if (nbytes < 9) {
+            amrex::Abort("FabCompress::Decompress: truncated block");
+        }
+        const double step = getDouble(p+1);
+        std::vector<unsigned char> planes(n*8);
+        unpackBits(p+9, nbytes-9, planes.data(), n*8);
+        std::int64_t q = 0;
+        for (Long i = 0; i < n; ++i) {
+            std::uint64_t z = 0;
+            for (int b = 0; b < 8; ++b) {
+                z |= static_cast<std::uint64_t>(planes[b*n+i]) << (8*b);
+            }
+            q += static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+            out[i] = static_cast<Real>(static_cast<double>(q) * step);
+        }
+        return;
+    }
+
+    std::vector<unsigned char> bytes;
+    const unsigned char* data;
+    if (method == Lossless)
+    {
+        bytes.resize(n*w);
+        std::vector<unsigned char> planes(n*w);
+        unpackBits(p+1, nbytes-1, planes.data(), n*w);
+        for (int b = 0; b < w; ++b) {
+            const unsigned char* pl = planes.data() + b*n;
+            if (n > 0) bytes[b] = pl[0];
+            for (Long i = 1; i < n; ++i) {
+                bytes[i*w+b] = pl[i] ^ bytes[(i-1)*w+b];
+            }
+        }
+        data = bytes.data();
+    }
+    else if (method == Raw)
+    {
+        if (nbytes != 1 + n*w) {
+            amrex::Abort("FabCompress::Decompress: raw block has the wrong size");
+        }
+        data = p+1;
+    }
+    else
+    {
+        amrex::Abort("FabCompress::Decompress: unknown method");
+        return;
+    }
+
+    if (rd == FPC::NativeRealDescriptor()) {
+        std::memcpy(out, data, n*w);
+    } else {
+        RealDescriptor::convertToNativeFormat(out, n, const_cast<unsigned char*>(data), rd);
+    }
+}
+
+}
+}
@@ -2,10 +2,30 @@
 #include <AMReX_MFIter.H>
 #include <AMReX_FabArray.H>
 #include <AMReX_FArrayBox.H>
+#include <AMReX_LayoutData.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
 
 namespace amrex {
 
 int MFIter::nextDynamicIndex = std::numeric_limits<int>::min();
+Vector<LayoutData<Real>*> MFIter::m_cost_registry;
+
+void
+MFIter::RegisterCost (LayoutData<Real>* cost)
+{
+    if (std::find(m_cost_registry.begin(), m_cost_registry.end(), cost) == m_cost_registry.end()) {
+        m_cost_registry.push_back(cost);
+    }
+}
+
+void
+MFIter::UnregisterCost (LayoutData<Real>* cost)
+{
+    m_cost_registry.erase(std::remove(m_cost_registry.begin(), m_cost_registry.end(), cost),
+                          m_cost_registry.end());
+}
 
 MFIter::MFIter (const FabArrayBase& fabarray_, 
 		unsigned char       flags_)
@@ -337,6 +357,16 @@ MFIter::Initialize ()
 #endif
 
 	typ = fabArray.boxArray().ixType();
+
+        for (auto cost : m_cost_registry) {
+            if (cost->boxArray().getRefID() == fabArray.boxArray().getRefID() &&
+                cost->DistributionMap().getRefID() == fabArray.DistributionMap().getRefID())
+            {
+                m_cost = cost;
+                m_cost_start = amrex::second();
+                break;
+            }
+        }
     }
 }
 
@@ -489,6 +519,17 @@ MFIter::grownnodaltilebox (int dir, IntVect const& a_ng) const noexcept
 void
 MFIter::operator++ () noexcept
 {
+    if (m_cost && currentIndex < endIndex)
+    {
+        const double t = amrex::second();
+        Real& c = (*m_cost)[*this];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        c += static_cast<Real>(t - m_cost_start);
+        m_cost_start = t;
+    }
+
 #ifdef _OPENMP
     if (dynamic)
     {
@@ -730,4 +771,112 @@ MFGhostIter::Initialize ()
     tile_array      = &(lta.tileArray);
 }
 
+
+void
+MFOverlapIter::Initialize (const IntVect& stencil_ng, bool do_tiling)
+{
+    const IntVect& tilesize = do_tiling ? FabArrayBase::mfiter_tile_size
+                                        : IntVect(AMREX_D_DECL(1024000,1024000,1024000));
+
+    // Note that tiles are stored as cell-centered boxes like in TileArray.
+    for (int i=0; i < fabArray.IndexArray().size(); ++i) {
+        int K = fabArray.IndexArray()[i];
+        const Box& vbx = fabArray.boxArray().getCellCenteredBox(K);
+        const Box& ibx = amrex::grow(vbx, -stencil_ng);
+
+        BoxList interior, boundary;
+        if (ibx.ok()) {
+            interior = BoxList(ibx, tilesize);
+            for (const Box& b : amrex::boxDiff(vbx, ibx)) {
+                BoxList tiles(b, tilesize);
+                boundary.catenate(tiles);
+            }
+        } else {
+            boundary = BoxList(vbx, tilesize);
+        }
+
+        for (const Box& b : interior) {
+            m_interior.indexMap.push_back(K);
+            m_interior.localIndexMap.push_back(i);
+            m_interior.tileArray.push_back(b);
+        }
+        for (const Box& b : boundary) {
+            m_boundary.indexMap.push_back(K);
+            m_boundary.localIndexMap.push_back(i);
+            m_boundary.tileArray.push_back(b);
+        }
+    }
+
+    m_interior.nuse = 0;
+    m_boundary.nuse = 0;
+    typ = fabArray.boxArray().ixType();
+
+    m_interior_phase = true;
+    setPhase(m_interior);
+    if (!isValid()) {
+        finishCommunication();
+    }
+}
+
+void
+MFOverlapIter::setPhase (FabArrayBase::TileArray& ta)
+{
+    int rit = 0;
+    int nworkers = 1;
+#ifdef BL_USE_TEAM
+    if (ParallelDescriptor::TeamSize() > 1) {
+	rit = ParallelDescriptor::MyRankInTeam();
+	nworkers = ParallelDescriptor::TeamSize();
+    }
+#endif
+
+    int tid = 0;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_num_threads();
+    if (nthreads > 1)
+	tid = omp_get_thread_num();
+#endif
+
+    int npes = nworkers*nthreads;
+    int pid = rit*nthreads+tid;
+
+    int n_tot_tiles = ta.indexMap.size();
+    int navg = n_tot_tiles / npes;
+    int nleft = n_tot_tiles - navg*npes;
+    int ntiles = navg;
+    if (pid < nleft) ntiles++;
+
+    beginIndex = pid*navg + std::min(pid,nleft);
+    endIndex = beginIndex + ntiles;
+    currentIndex = beginIndex;
+
+    index_map       = &(ta.indexMap);
+    local_index_map = &(ta.localIndexMap);
+    tile_array      = &(ta.tileArray);
+}
+
+void
+MFOverlapIter::finishCommunication ()
+{
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+    m_finish();
+    // omp single has an implicit barrier.
+
+    m_interior_phase = false;
+    setPhase(m_boundary);
+}
+
+void
+MFOverlapIter::operator++ ()
+{
+    MFIter::operator++();
+    if (m_interior_phase && !isValid()) {
+        finishCommunication();
+    }
+}
+
 }
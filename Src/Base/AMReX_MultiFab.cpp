@@ -1248,31 +1248,6 @@ MultiFab::negate (const Box& region, int comp, int num_comp, int nghost)
     FabArray<FArrayBox>::mult(-1.,region,comp,num_comp,nghost);
 }
 
-void
-MultiFab::SumBoundary (int scomp, int ncomp, IntVect const& nghost, const Periodicity& period)
-{
-    BL_PROFILE("MultiFab::SumBoundary()");
-
-    if ( n_grow == IntVect::TheZeroVector() and boxArray().ixType().cellCentered()) return;
-
-    MultiFab tmp(boxArray(), DistributionMap(), ncomp, n_grow, MFInfo(), Factory());
-    MultiFab::Copy(tmp, *this, scomp, 0, ncomp, n_grow);
-    this->setVal(0.0, scomp, ncomp, nghost);
-    this->copy(tmp,0,scomp,ncomp,n_grow,nghost,period,FabArrayBase::ADD);
-}
-
-void
-MultiFab::SumBoundary (int scomp, int ncomp, const Periodicity& period)
-{
-    SumBoundary(scomp, ncomp, IntVect(0), period);
-}
-
-void
-MultiFab::SumBoundary (const Periodicity& period)
-{
-    SumBoundary(0, n_comp, IntVect(0), period);
-}
-
 std::unique_ptr<MultiFab>
 MultiFab::OverlapMask (const Periodicity& period) const
 {
@@ -1389,12 +1364,8 @@ MultiFab::OverrideSync (const iMultiFab& msk, const Periodicity& period)
 void
 FillBoundary (Vector<MultiFab*> const& mf, const Periodicity& period)
 {
-    for (auto x : mf) {
-        x->FillBoundary(period);
-    }
-// The following is actually slower on summit
-//    Vector<FabArray<FArrayBox>*> fa{mf.begin(),mf.end()};
-//    FillBoundary(fa,period);
+    Vector<FabArray<FArrayBox>*> fa{mf.begin(),mf.end()};
+    FillBoundary(fa,period);
 }
 
 }
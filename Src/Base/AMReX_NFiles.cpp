@@ -1,7 +1,11 @@
 
 #include <AMReX_Utility.H>
 #include <AMReX_NFiles.H>
+#include <AMReX_ParallelReduce.H>
+#include <algorithm>
+#include <cstring>
 #include <deque>
+#include <limits>
 
 namespace amrex {
 
@@ -203,6 +207,112 @@ NFilesIter::~NFilesIter() {
 }
 
 
+void NFilesIter::WriteAggregated(const char *data, Long nbytes, Long bufferSize,
+                                 int aggregatorRank)
+{
+
+  BL_PROFILE("NFilesIter::WriteAggregated()");
+  BL_ASSERT(useStaticSetSelection && ! useSparseFPP);
+  AMREX_ALWAYS_ASSERT(bufferSize > 0 && bufferSize <= std::numeric_limits<int>::max());
+
+  const int tag(ParallelDescriptor::SeqNum());
+
+  Vector<Long> nBytes(nProcs, 0);
+#ifdef BL_USE_MPI
+  ParallelAllGather::AllGather(nbytes, nBytes.dataPtr(), ParallelDescriptor::Communicator());
+#else
+  nBytes[0] = nbytes;
+#endif
+
+  // ---- the ranks in my set in set order and where their data go in the file
+  Vector<int> setRanks;
+  Vector<Long> setOffsets;
+  Long fileBytes(0), myOffset(0);
+  for(int i(0); i < nProcs; ++i) {
+    if(FileNumber(nOutFiles, i, groupSets) == fileNumber) {
+      if(i == myProc) {
+        myOffset = fileBytes;
+      }
+      setRanks.push_back(i);
+      setOffsets.push_back(fileBytes);
+      fileBytes += nBytes[i];
+    }
+  }
+  const int setSize(setRanks.size());
+  const int aggregatorProc(setRanks[(aggregatorRank < 0 ? fileNumber : aggregatorRank) % setSize]);
+
+  if(myProc != aggregatorProc) {
+    // ---- send the data split where the pieces of the file begin
+    Vector<MPI_Request> reqs;
+    for(Long pos(0); pos < nbytes; ) {
+      const Long n(std::min(nbytes - pos, bufferSize - (myOffset + pos) % bufferSize));
+      reqs.push_back(ParallelDescriptor::Asend(data + pos, n, aggregatorProc, tag).req());
+      pos += n;
+    }
+    Vector<MPI_Status> stats(reqs.size());
+    ParallelDescriptor::Waitall(reqs, stats);
+    finishedWriting = true;
+    return;
+  }
+
+  fileStream.open(fullFileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+  if( ! fileStream.good()) {
+    amrex::FileOpenFailed(fullFileName);
+  }
+
+  const Long nPieces((fileBytes + bufferSize - 1) / bufferSize);
+  Vector<char> pieceBuffer[2];
+  Vector<MPI_Request> pieceReqs[2];
+  for(int ib(0); ib < 2; ++ib) {
+    pieceBuffer[ib].resize(std::min(bufferSize, fileBytes));
+  }
+
+  // ---- post the receives for a piece, copy my own part of it
+  auto startPiece = [&] (Long piece) {
+    const Long pBegin(piece * bufferSize);
+    const Long pEnd(std::min(pBegin + bufferSize, fileBytes));
+    char *buffer = pieceBuffer[piece % 2].dataPtr();
+    for(int k(0); k < setRanks.size(); ++k) {
+      const int rank(setRanks[k]);
+      const Long b(std::max(pBegin, setOffsets[k]));
+      const Long e(std::min(pEnd, setOffsets[k] + nBytes[rank]));
+      if(b >= e) {
+        continue;
+      }
+      if(rank == myProc) {
+        std::memcpy(buffer + (b - pBegin), data + (b - setOffsets[k]), e - b);
+      } else {
+        pieceReqs[piece % 2].push_back(
+          ParallelDescriptor::Arecv(buffer + (b - pBegin), e - b, rank, tag).req());
+      }
+    }
+  };
+
+  if(nPieces > 0) {
+    startPiece(0);
+  }
+  for(Long piece(0); piece < nPieces; ++piece) {
+    Vector<MPI_Request> &reqs = pieceReqs[piece % 2];
+    Vector<MPI_Status> stats(reqs.size());
+    ParallelDescriptor::Waitall(reqs, stats);
+    reqs.clear();
+    if(piece + 1 < nPieces) {
+      startPiece(piece + 1);
+    }
+    const Long pBegin(piece * bufferSize);
+    const Long pEnd(std::min(pBegin + bufferSize, fileBytes));
+    fileStream.write(pieceBuffer[piece % 2].dataPtr(), pEnd - pBegin);
+  }
+
+  fileStream.flush();
+  fileStream.close();
+  if( ! fileStream.good()) {
+    amrex::Abort("NFilesIter::WriteAggregated:  error writing " + fullFileName);
+  }
+  finishedWriting = true;
+}
+
+
 bool NFilesIter::ReadyToWrite(bool appendFirst) {
 
 #ifdef BL_USE_MPI
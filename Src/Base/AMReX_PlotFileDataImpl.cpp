@@ -2,6 +2,7 @@
 #include <AMReX_PlotFileDataImpl.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_Utility.H>
 
 namespace amrex {
 
@@ -11,6 +12,18 @@ namespace {
         constexpr std::streamsize bl_ignore_max { 100000 };
         is.ignore(bl_ignore_max, '\n');
     }
+
+    // The mapped files are copied on the host.  With GPUs, The_Arena's
+    // memory may not be accessible from the host, so we read with VisMF.
+    bool copyFromMap (VisMF const& vismf)
+    {
+#ifdef AMREX_USE_GPU
+        amrex::ignore_unused(vismf);
+        return false;
+#else
+        return vismf.canMap();
+#endif
+    }
 }
 
 PlotFileDataImpl::PlotFileDataImpl (std::string const& plotfile_name)
@@ -115,11 +128,63 @@ PlotFileDataImpl::syncDistributionMap (int level, PlotFileDataImpl const& src) n
     }
 }
 
+MultiFab
+PlotFileDataImpl::get (int level, Box const& region, int icomp, int ncomp) noexcept
+{
+    AMREX_ALWAYS_ASSERT(icomp >= 0 && ncomp > 0 && icomp+ncomp <= m_ncomp);
+
+    BoxList bl(m_ba[level].ixType());
+    Vector<int> gids, pmap;
+    for (int gid = 0, N = m_ba[level].size(); gid < N; ++gid) {
+        const Box& bx = m_ba[level][gid] & region;
+        if (bx.ok()) {
+            bl.push_back(bx);
+            gids.push_back(gid);
+            pmap.push_back(m_dmap[level][gid]);
+        }
+    }
+
+    if (bl.isEmpty()) return MultiFab();
+
+    // Each box is read by the owner of the box it comes from.
+    MultiFab mf(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)), ncomp, 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gids[mfi.index()], bx, icomp, ncomp));
+        mf[mfi].copy<RunOn::Host>(*srcfab, bx, 0, bx, 0, ncomp);
+    }
+    return mf;
+}
+
+FArrayBox
+PlotFileDataImpl::getFab (int level, int gid, Box const& region, int icomp, int ncomp) noexcept
+{
+    AMREX_ALWAYS_ASSERT(icomp >= 0 && ncomp > 0 && icomp+ncomp <= m_ncomp);
+    std::unique_ptr<FArrayBox> fab(m_vismf[level]->readFAB(gid, region & m_ba[level][gid],
+                                                           icomp, ncomp));
+    return std::move(*fab);
+}
+
+Array4<Real const>
+PlotFileDataImpl::const_array (int level, int gid) const noexcept
+{
+    return m_vismf[level]->const_array(gid);
+}
+
 MultiFab
 PlotFileDataImpl::get (int level) noexcept
 {
     MultiFab mf(m_ba[level], m_dmap[level], m_ncomp, m_ngrow[level]);
-    VisMF::Read(mf, m_mf_name[level]);
+    if (copyFromMap(*m_vismf[level])) {
+        // Copy straight from the mapped files instead of reading them
+        // into temporary buffers.
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const FArrayBox srcfab(m_vismf[level]->const_array(mfi.index()), m_ba[level].ixType());
+            mf[mfi].copy<RunOn::Host>(srcfab);
+        }
+    } else {
+        VisMF::Read(mf, m_mf_name[level]);
+    }
     return mf;
 }
 
@@ -132,11 +197,17 @@ PlotFileDataImpl::get (int level, std::string const& varname) noexcept
         amrex::Abort("PlotFileDataImpl::get: varname not found "+varname);
     } else {
         int icomp = std::distance(std::begin(m_var_names), r);
+        const bool use_map = copyFromMap(*m_vismf[level]);
         for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
             int gid = mfi.index();
             FArrayBox& dstfab = mf[mfi];
-            std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
-            dstfab.copy<RunOn::Host>(*srcfab);
+            if (use_map) {
+                const FArrayBox srcfab(m_vismf[level]->const_array(gid), m_ba[level].ixType());
+                dstfab.copy<RunOn::Host>(srcfab, icomp, 0, 1);
+            } else {
+                std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
+                dstfab.copy<RunOn::Host>(*srcfab);
+            }
         }
     }
     return mf;
@@ -0,0 +1,369 @@
+#include <atomic>
+#include <algorithm>
+#include <functional>
+
+#include <AMReX_TArena.H>
+#include <AMReX_BLassert.H>
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParallelReduce.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+constexpr std::size_t TArena::min_class_size;
+constexpr std::size_t TArena::slab_size;
+constexpr std::size_t TArena::cache_size;
+constexpr std::size_t TArena::thread_cache_size;
+
+namespace {
+    //! The header in front of each block holds its size class, or -1 if it
+    //! comes from the CArena for large requests.
+    constexpr int large_class = -1;
+
+    //! Threads are numbered in the order they first use a TArena.  Unlike
+    //! omp_get_thread_num(), this also distinguishes threads not created by
+    //! OpenMP (e.g., the thread of AsyncOut).
+    int thread_slot () noexcept
+    {
+        static std::atomic<int> next_slot{0};
+        thread_local int slot = next_slot++;
+        return slot;
+    }
+}
+
+TArena::TArena (std::size_t max_size, ArenaInfo info, std::size_t release_threshold)
+    : m_large(0, info)
+{
+    arena_info = info;
+
+#ifdef AMREX_USE_GPU
+    if (!arena_info.use_cpu_memory &&
+        !arena_info.device_use_managed_memory &&
+        !arena_info.device_use_hostalloc)
+    {
+        amrex::Abort("TArena: device memory is not supported");
+    }
+#endif
+
+    if (max_size == 0) max_size = DefaultMaxSize;
+    m_nclasses = sizeClass(Arena::align(max_size) + Arena::align_size) + 1;
+    m_max_size = classSize(m_nclasses-1);
+    m_used = 0;
+    m_central_bytes = 0;
+    m_release_threshold = release_threshold;
+    m_release_at = release_threshold;
+    m_actually_used = 0;
+
+#ifdef _OPENMP
+    const int nslots = omp_get_max_threads() + 4;
+#else
+    const int nslots = 4;
+#endif
+    m_cache.resize(nslots);
+    for (auto& cache : m_cache) {
+        cache.reset(new ThreadCache);
+        cache->m_bins.resize(m_nclasses);
+    }
+    m_central.resize(m_nclasses);
+}
+
+TArena::~TArena ()
+{
+    for (unsigned int i = 0, N = m_alloc.size(); i < N; i++) {
+        deallocate_system(m_alloc[i].first, m_alloc[i].second);
+    }
+}
+
+int
+TArena::sizeClass (std::size_t nbytes) const noexcept
+{
+    if (nbytes <= min_class_size) return 0;
+    // Class 1+4*o+s holds blocks of (5+s)/4 * min_class_size*2^o bytes.
+    const std::size_t m = nbytes-1;
+    int o = 0;
+    while ((min_class_size << (o+1)) <= m) ++o;
+    const std::size_t lo = min_class_size << o;
+    return 1 + 4*o + static_cast<int>((m-lo)/(lo/4));
+}
+
+std::size_t
+TArena::classSize (int c) const noexcept
+{
+    if (c == 0) return min_class_size;
+    const int o = (c-1)/4;
+    const int s = (c-1)%4;
+    const std::size_t lo = min_class_size << o;
+    return lo + (lo/4)*(s+1);
+}
+
+int
+TArena::cacheLimit (int c) const noexcept
+{
+    return static_cast<int>(std::max(std::size_t(2), cache_size/classSize(c)));
+}
+
+void
+TArena::refill (int c, int n, std::vector<void*>& bin)
+{
+    auto& central = m_central[c];
+    const std::size_t sz = classSize(c);
+    if (central.empty())
+    {
+        // With huge pages, the system allocates multiples of 2 MB anyway.
+        const std::size_t slab = arena_info.use_huge_pages ? 2*slab_size : slab_size;
+        const std::size_t nblocks = std::max(std::size_t(1), slab/sz);
+        const std::size_t N = nblocks*sz;
+        char* p = static_cast<char*>(allocate_system(N));
+        m_alloc.push_back(std::make_pair(static_cast<void*>(p),N));
+        m_used += N;
+        m_central_bytes += N;
+        for (std::size_t i = 0; i < nblocks; ++i) {
+            central.push_back(p + (nblocks-1-i)*sz);
+        }
+    }
+    const int ntake = std::min(n, static_cast<int>(central.size()));
+    bin.insert(bin.end(), central.end()-ntake, central.end());
+    central.resize(central.size()-ntake);
+    m_central_bytes -= ntake*sz;
+    if (m_release_threshold > 0) {
+        m_release_at = std::min(m_release_at, m_central_bytes + m_release_threshold);
+    }
+}
+
+std::size_t
+TArena::releaseFreeSlabs ()
+{
+    if (m_alloc.empty()) return 0;
+
+    using Slab = std::pair<void*,std::size_t>;
+    std::sort(m_alloc.begin(), m_alloc.end(),
+              [] (Slab const& a, Slab const& b) { return std::less<void*>()(a.first, b.first); });
+    auto slab_of = [this] (void* p) -> std::size_t
+    {
+        auto it = std::upper_bound(m_alloc.begin(), m_alloc.end(), p,
+                                   [] (void* q, Slab const& a) { return std::less<void*>()(q, a.first); });
+        return (it - m_alloc.begin()) - 1;
+    };
+
+    // A slab is free if the free blocks in it add up to its size.
+    const std::size_t nslabs = m_alloc.size();
+    std::vector<std::size_t> free_bytes(nslabs, 0);
+    for (int c = 0; c < m_nclasses; ++c) {
+        const std::size_t sz = classSize(c);
+        for (void* p : m_central[c]) {
+            free_bytes[slab_of(p)] += sz;
+        }
+    }
+    std::vector<char> is_free(nslabs);
+    bool any_free = false;
+    for (std::size_t i = 0; i < nslabs; ++i) {
+        is_free[i] = (free_bytes[i] == m_alloc[i].second);
+        any_free = any_free || is_free[i];
+    }
+    if (!any_free) return 0;
+
+    for (auto& central : m_central) {
+        central.erase(std::remove_if(central.begin(), central.end(),
+                                     [&] (void* p) { return is_free[slab_of(p)]; }),
+                      central.end());
+    }
+
+    std::size_t released = 0;
+    std::size_t nkeep = 0;
+    for (std::size_t i = 0; i < nslabs; ++i) {
+        if (is_free[i]) {
+            deallocate_system(m_alloc[i].first, m_alloc[i].second);
+            released += m_alloc[i].second;
+        } else {
+            m_alloc[nkeep++] = m_alloc[i];
+        }
+    }
+    m_alloc.resize(nkeep);
+    m_used -= released;
+    m_central_bytes -= released;
+    return released;
+}
+
+void
+TArena::maybeRelease ()
+{
+    if (m_release_threshold > 0 && m_central_bytes > m_release_at) {
+        releaseFreeSlabs();
+        // Do not search again until as much more memory is freed.
+        m_release_at = m_central_bytes + m_release_threshold;
+    }
+}
+
+std::size_t
+TArena::release ()
+{
+    std::lock_guard<std::mutex> lock(tarena_mutex);
+    const int slot = thread_slot();
+    if (slot < static_cast<int>(m_cache.size()))
+    {
+        ThreadCache& cache = *m_cache[slot];
+        for (int c = 0; c < m_nclasses; ++c) {
+            auto& bin = cache.m_bins[c];
+            m_central[c].insert(m_central[c].end(), bin.begin(), bin.end());
+            m_central_bytes += bin.size()*classSize(c);
+            bin.clear();
+        }
+        cache.m_cached_bytes = 0;
+    }
+    const std::size_t released = releaseFreeSlabs();
+    if (m_release_threshold > 0) {
+        m_release_at = m_central_bytes + m_release_threshold;
+    }
+    return released;
+}
+
+void*
+TArena::alloc (std::size_t nbytes)
+{
+    nbytes = Arena::align(nbytes == 0 ? 1 : nbytes) + Arena::align_size;
+
+    char* p;
+    int c;
+
+    if (nbytes > m_max_size)
+    {
+        p = static_cast<char*>(m_large.alloc(nbytes));
+        c = large_class;
+    }
+    else
+    {
+        c = sizeClass(nbytes);
+        const int slot = thread_slot();
+        if (slot < static_cast<int>(m_cache.size()))
+        {
+            ThreadCache& cache = *m_cache[slot];
+            auto& bin = cache.m_bins[c];
+            if (bin.empty()) {
+                std::lock_guard<std::mutex> lock(tarena_mutex);
+                refill(c, std::max(1,cacheLimit(c)/2), bin);
+                cache.m_cached_bytes += bin.size()*classSize(c);
+            }
+            p = static_cast<char*>(bin.back());
+            bin.pop_back();
+            cache.m_cached_bytes -= classSize(c);
+            cache.m_actually_used += classSize(c);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(tarena_mutex);
+            std::vector<void*> bin;
+            refill(c, 1, bin);
+            p = static_cast<char*>(bin.back());
+            m_actually_used += classSize(c);
+        }
+    }
+
+    *reinterpret_cast<int*>(p) = c;
+    return p + Arena::align_size;
+}
+
+void
+TArena::free (void* vp)
+{
+    if (vp == 0) return;
+
+    char* p = static_cast<char*>(vp) - Arena::align_size;
+    const int c = *reinterpret_cast<int*>(p);
+
+    if (c == large_class)
+    {
+        m_large.free(p);
+        return;
+    }
+
+    BL_ASSERT(c >= 0 && c < m_nclasses);
+
+    const int slot = thread_slot();
+    if (slot < static_cast<int>(m_cache.size()))
+    {
+        ThreadCache& cache = *m_cache[slot];
+        auto& bin = cache.m_bins[c];
+        bin.push_back(p);
+        cache.m_cached_bytes += classSize(c);
+        cache.m_actually_used -= classSize(c);
+        const int limit = cacheLimit(c);
+        if (static_cast<int>(bin.size()) > limit) {
+            // Give the older half of the cached blocks back to other
+            // threads, and keep the recently used ones.
+            const int nback = limit/2;
+            std::lock_guard<std::mutex> lock(tarena_mutex);
+            auto& central = m_central[c];
+            central.insert(central.end(), bin.begin(), bin.begin()+nback);
+            bin.erase(bin.begin(), bin.begin()+nback);
+            cache.m_cached_bytes -= nback*classSize(c);
+            m_central_bytes += nback*classSize(c);
+            maybeRelease();
+        }
+        else if (cache.m_cached_bytes > thread_cache_size) {
+            // Give the older half of the blocks of every size class back.
+            std::lock_guard<std::mutex> lock(tarena_mutex);
+            for (int ic = 0; ic < m_nclasses; ++ic) {
+                auto& b = cache.m_bins[ic];
+                const std::size_t nback = (b.size()+1)/2;
+                m_central[ic].insert(m_central[ic].end(), b.begin(), b.begin()+nback);
+                b.erase(b.begin(), b.begin()+nback);
+                cache.m_cached_bytes -= nback*classSize(ic);
+                m_central_bytes += nback*classSize(ic);
+            }
+            maybeRelease();
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(tarena_mutex);
+        m_central[c].push_back(p);
+        m_central_bytes += classSize(c);
+        m_actually_used -= classSize(c);
+        maybeRelease();
+    }
+}
+
+std::size_t
+TArena::heap_space_used () const noexcept
+{
+    return m_used + m_large.heap_space_used();
+}
+
+std::size_t
+TArena::heap_space_actually_used () const noexcept
+{
+    Long r = m_actually_used;
+    for (auto const& cache : m_cache) {
+        r += cache->m_actually_used;
+    }
+    return static_cast<std::size_t>(std::max(r,Long(0))) + m_large.heap_space_actually_used();
+}
+
+void
+TArena::PrintUsage (std::string const& name) const
+{
+    Long min_megabytes = heap_space_used() / (1024*1024);
+    Long max_megabytes = min_megabytes;
+    Long actual_min_megabytes = heap_space_actually_used() / (1024*1024);
+    Long actual_max_megabytes = actual_min_megabytes;
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelReduce::Min<Long>({min_megabytes, actual_min_megabytes},
+                              IOProc, ParallelDescriptor::Communicator());
+    ParallelReduce::Max<Long>({max_megabytes, actual_max_megabytes},
+                              IOProc, ParallelDescriptor::Communicator());
+#ifdef AMREX_USE_MPI
+    amrex::Print() << "[" << name << "]" << " space (MB) allocated spread across MPI: ["
+                   << min_megabytes << " ... " << max_megabytes << "]\n"
+                   << "[" << name << "]" << " space (MB) used      spread across MPI: ["
+                   << actual_min_megabytes << " ... " << actual_max_megabytes << "]\n";
+#else
+    amrex::Print() << "[" << name << "]" << " space allocated (MB): " << min_megabytes << "\n";
+    amrex::Print() << "[" << name << "]" << " space used      (MB): " << actual_min_megabytes << "\n";
+#endif
+}
+
+}
@@ -534,6 +534,12 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
     }
 }
 
+const std::string*
+TinyProfiler::CurrentTimer () noexcept
+{
+    return ttstack.empty() ? nullptr : std::get<2>(ttstack.back());
+}
+
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
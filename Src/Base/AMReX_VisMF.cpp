@@ -11,12 +11,20 @@
 #include <memory>
 #include <numeric>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <AMReX_ccse-mpi.H>
 #include <AMReX_Utility.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_NFiles.H>
 #include <AMReX_FPC.H>
+#include <AMReX_FabCompress.H>
 #include <AMReX_FabArrayUtility.H>
 #include <AMReX_AsyncOut.H>
 
@@ -38,9 +46,18 @@ bool VisMF::checkFilePositions(false);
 bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
+bool VisMF::useAggregatedWrite(false);
+#ifdef _WIN32
+bool VisMF::useMMap(false);
+#else
+bool VisMF::useMMap(true);
+#endif
 bool VisMF::allowSparseWrites(true);
+Vector<Real> VisMF::compressionTolerance;
 
 Long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
+Long VisMF::aggregatorBufferSize(VisMF::Aggregator_Buffer_Size);
+int VisMF::aggregatorRank(0);
 
 //
 // Set these in Initialize().
@@ -85,8 +102,13 @@ VisMF::Initialize ()
     pp.query("usepersistentifstreams", usePersistentIFStreams);
     pp.query("usesynchronousreads", useSynchronousReads);
     pp.query("usedynamicsetselection", useDynamicSetSelection);
+    pp.query("useaggregatedwrite", useAggregatedWrite);
+    pp.query("aggregatorbuffersize", aggregatorBufferSize);
+    pp.query("aggregatorrank", aggregatorRank);
+    pp.query("usemmap", useMMap);
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
+    pp.queryarr("compressiontolerance", compressionTolerance);
 
     initialized = true;
 }
@@ -259,6 +281,71 @@ operator>> (std::istream&         is,
     return is;
 }
 
+static
+std::ostream&
+operator<< (std::ostream&               os,
+            const Vector< Vector<Long> >& ar)
+{
+    Long i(0), N(ar.size()), M = (N == 0) ? 0 : ar[0].size();
+
+    os << N << ',' << M << '\n';
+
+    for( ; i < N; ++i) {
+        BL_ASSERT(ar[i].size() == M);
+
+        for(Long j(0); j < M; ++j) {
+            os << ar[i][j] << ',';
+        }
+        os << '\n';
+    }
+
+    if( ! os.good()) {
+        amrex::Error("Write of Vector<Vector<Long>> failed");
+    }
+
+    return os;
+}
+
+static
+std::istream&
+operator>> (std::istream&         is,
+            Vector< Vector<Long> >& ar)
+{
+    char ch;
+    Long i(0), N, M;
+
+    is >> N >> ch >> M;
+
+    if( N < 0 ) {
+      amrex::Error("Expected a positive integer, N, got something else");
+    }
+    if( M < 0 ) {
+      amrex::Error("Expected a positive integer, M, got something else");
+    }
+    if( ch != ',' ) {
+      amrex::Error("Expected a ',' got something else");
+    }
+
+    ar.resize(N);
+
+    for( ; i < N; ++i) {
+        ar[i].resize(M);
+
+        for(Long j = 0; j < M; ++j) {
+            is >> ar[i][j] >> ch;
+	    if( ch != ',' ) {
+	      amrex::Error("Expected a ',' got something else");
+	    }
+        }
+    }
+
+    if( ! is.good()) {
+        amrex::Error("Read of Vector<Vector<Long>> failed");
+    }
+
+    return is;
+}
+
 std::ostream&
 operator<< (std::ostream        &os,
             const VisMF::Header &hd)
@@ -284,6 +371,10 @@ operator<< (std::ostream        &os,
 
     os << hd.m_fod      << '\n';
 
+    if(hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+      os << hd.m_csize    << '\n';
+    }
+
     if(hd.m_vers == VisMF::Header::Version_v1 ||
        hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
     {
@@ -291,7 +382,9 @@ operator<< (std::ostream        &os,
       os << hd.m_max      << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
+    {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
       for(int i(0); i < hd.m_famin.size(); ++i) {
@@ -304,9 +397,10 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
@@ -368,6 +462,11 @@ operator>> (std::istream  &is,
     is >> hd.m_fod;
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
+    if(hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+      is >> hd.m_csize;
+      BL_ASSERT(hd.m_ba.size() == hd.m_csize.size());
+    }
+
     if(hd.m_vers == VisMF::Header::Version_v1 ||
        hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
     {
@@ -377,7 +476,9 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
+    {
       char ch;
       hd.m_famin.resize(hd.m_ncomp);
       hd.m_famax.resize(hd.m_ncomp);
@@ -394,9 +495,10 @@ operator>> (std::istream  &is,
 	}
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       is >> hd.m_writtenRD;
     }
@@ -532,6 +634,92 @@ VisMF::clear (int fabIndex,
     m_pa[compIndex][fabIndex] = 0;
 }
 
+bool
+VisMF::canMap () const
+{
+#ifdef _WIN32
+    return false;
+#else
+    return useMMap && NoFabHeader(m_hdr)
+        && m_hdr.m_vers != VisMF::Header::NoFabHeaderCompressed_v1
+        && m_hdr.m_writtenRD == FPC::NativeRealDescriptor();
+#endif
+}
+
+Array4<Real const>
+VisMF::const_array (int fabIndex) const
+{
+    Box fab_box(m_hdr.m_ba[fabIndex]);
+    if(m_hdr.m_ngrow.max() > 0) {
+        fab_box.grow(m_hdr.m_ngrow);
+    }
+
+    if(canMap()) {
+        std::string FullName(VisMF::DirName(m_fafabname));
+        FullName += m_hdr.m_fod[fabIndex].m_name;
+        const MappedFile &mapped = mapFile(FullName);
+        const Long head(m_hdr.m_fod[fabIndex].m_head);
+        const Long nbytes(fab_box.numPts() * m_hdr.m_ncomp * sizeof(Real));
+        // ---- the offsets of the fabs are multiples of sizeof(Real) unless
+        // ---- the file was written by other means, so check anyway
+        if(mapped.m_ptr != nullptr && head % sizeof(Real) == 0 && head + nbytes <= mapped.m_size) {
+            return makeArray4(reinterpret_cast<Real const*>(mapped.m_ptr + head),
+                              fab_box, m_hdr.m_ncomp);
+        }
+    }
+
+    if(m_fab.size() == 0) {
+        m_fab.resize(m_hdr.m_ba.size());
+    }
+    if( ! m_fab[fabIndex]) {
+        m_fab[fabIndex].reset(VisMF::readFAB(fabIndex, m_fafabname, m_hdr, -1));
+    }
+    return m_fab[fabIndex]->const_array();
+}
+
+const VisMF::MappedFile&
+VisMF::mapFile (const std::string &fileName) const
+{
+    auto it = m_mapped.find(fileName);
+    if(it != m_mapped.end()) {
+        return it->second;
+    }
+
+    MappedFile &mapped = m_mapped[fileName];
+#ifndef _WIN32
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        amrex::FileOpenFailed(fileName);
+    }
+    struct stat st;
+    if(::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED) {
+            mapped.m_ptr  = static_cast<char *>(p);
+            mapped.m_size = st.st_size;
+        } else if(verbose) {
+            amrex::AllPrint() << "VisMF::mapFile:  mmap failed for " << fileName
+                              << ", reading instead" << std::endl;
+        }
+    }
+    ::close(fd);  // ---- the mapping stays valid
+#endif
+    return mapped;
+}
+
+void
+VisMF::unmapFiles ()
+{
+#ifndef _WIN32
+    for(auto const& kv : m_mapped) {
+        if(kv.second.m_ptr != nullptr) {
+            ::munmap(kv.second.m_ptr, kv.second.m_size);
+        }
+    }
+#endif
+    m_mapped.clear();
+}
+
 Long
 VisMF::FileOffset (std::ostream& os)
 {
@@ -562,6 +750,25 @@ VisMF::readFAB (int idx,
     return VisMF::readFAB(idx, m_fafabname, m_hdr, ncomp);
 }
 
+FArrayBox*
+VisMF::readFAB (int        idx,
+                const Box &region,
+                int        icomp,
+                int        ncomp)
+{
+    if(canMap()) {
+        const FArrayBox src(const_array(idx), m_hdr.m_ba.ixType());
+        const Box bx(region & src.box());
+        if( ! bx.ok()) {
+            amrex::Abort("VisMF::readFAB:  region does not intersect the fab");
+        }
+        FArrayBox *fab = new FArrayBox(bx, ncomp);
+        fab->copy<RunOn::Host>(src, bx, icomp, bx, 0, ncomp);
+        return fab;
+    }
+    return VisMF::readFAB(idx, m_fafabname, m_hdr, region, icomp, ncomp);
+}
+
 std::string
 VisMF::BaseName (const std::string& filename)
 {
@@ -673,7 +880,12 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
              mf.arena() == The_Device_Arena() or
              mf.arena() == The_Managed_Arena());
 
-    if(version == NoFabHeaderFAMinMax_v1) {
+    if(version == NoFabHeaderCompressed_v1) {
+      // ---- the compressed sizes are filled in by Write
+      m_csize.resize(m_ba.size(), Vector<Long>(m_ncomp, 0));
+    }
+
+    if(version == NoFabHeaderFAMinMax_v1 || version == NoFabHeaderCompressed_v1) {
       // ---- calculate FabArray min max values only
       m_min.clear();
       m_max.clear();
@@ -1017,12 +1229,63 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
 
+    // ---- compress all the local fabs before waiting for our turn to write
+    bool compressed(currentVersion == VisMF::Header::NoFabHeaderCompressed_v1);
+    Vector<char> compressedData;
+    if(compressed) {
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const FArrayBox &fab = mf[mfi];
+            const Long npts(fab.box().numPts());
+            Vector<Long> &csize = hdr.m_csize[mfi.index()];
+            for(int icomp(0); icomp < mf.nComp(); ++icomp) {
+                csize[icomp] = FabCompress::Compress(fab.dataPtr(icomp), npts, *whichRD,
+                                                     VisMF::CompressionTolerance(icomp),
+                                                     compressedData);
+            }
+        }
+    }
+
+    // ---- sparse data are written by the ranks that have them
+    bool aggregate(useAggregatedWrite && ! useSparseFPP);
+
     if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
-    } else if(useDynamicSetSelection) {
+    } else if(useDynamicSetSelection && ! aggregate) {
         nfi.SetDynamic();
     }
-    for( ; nfi.ReadyToWrite(); ++nfi) {
+
+    if(aggregate) {
+        if(compressed) {
+            nfi.WriteAggregated(compressedData.dataPtr(), compressedData.size(),
+                                aggregatorBufferSize, aggregatorRank);
+            bytesWritten += compressedData.size();
+        } else {
+            const FABio &fio = FArrayBox::getFABio();
+            Long nBytes(0);
+            for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const FArrayBox &fab = mf[mfi];
+                if(oldHeader) {
+                    std::stringstream hss;
+                    fio.write_header(hss, fab, fab.nComp());
+                    nBytes += static_cast<std::streamoff>(hss.tellp());
+                }
+                nBytes += fab.box().numPts() * mf.nComp() * whichRD->numBytes();
+            }
+            Vector<char> allFabData(nBytes);
+            CombineFABs(mf, *whichRD, oldHeader, allFabData.dataPtr());
+            nfi.WriteAggregated(allFabData.dataPtr(), nBytes, aggregatorBufferSize,
+                                aggregatorRank);
+            bytesWritten += nBytes;
+        }
+    }
+
+    for( ; ! aggregate && nfi.ReadyToWrite(); ++nfi) {
+        if(compressed) {
+            nfi.Stream().write(compressedData.dataPtr(), compressedData.size());
+            nfi.Stream().flush();
+            bytesWritten += compressedData.size();
+            continue;
+        }
         // ---- find the total number of bytes including fab headers if needed
         const FABio &fio = FArrayBox::getFABio();
         int whichRDBytes(whichRD->numBytes()), nFABs(0);
@@ -1049,29 +1312,7 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         }
 
         if(canCombineFABs) {
-            Long writePosition(0);
-            for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                int hLength(0);
-                const FArrayBox &fab = mf[mfi];
-                writeDataItems = fab.box().numPts() * mf.nComp();
-                writeDataSize = writeDataItems * whichRDBytes;
-                char *afPtr = allFabData + writePosition;
-                if(oldHeader) {
-                    std::stringstream hss;
-                    fio.write_header(hss, fab, fab.nComp());
-                    hLength = static_cast<std::streamoff>(hss.tellp());
-                    auto tstr = hss.str();
-                    memcpy(afPtr, tstr.c_str(), hLength);  // ---- the fab header
-                }
-                if(doConvert) {
-                    RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
-                                                            writeDataItems,
-                                                            fab.dataPtr(), *whichRD);
-                } else {    // ---- copy from the fab
-                    memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
-                }
-                writePosition += hLength + writeDataSize;
-            }
+            CombineFABs(mf, *whichRD, oldHeader, allFabData);
             nfi.Stream().write(allFabData, bytesWritten);
             nfi.Stream().flush();
             delete [] allFabData;
@@ -1131,6 +1372,40 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+void
+VisMF::CombineFABs (const FabArray<FArrayBox> &mf,
+                    const RealDescriptor      &whichRD,
+                    bool                       oldHeader,
+                    char                      *dest)
+{
+    const FABio &fio = FArrayBox::getFABio();
+    bool doConvert(whichRD != FPC::NativeRealDescriptor());
+    Long writePosition(0);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        int hLength(0);
+        const FArrayBox &fab = mf[mfi];
+        Long writeDataItems = fab.box().numPts() * mf.nComp();
+        Long writeDataSize = writeDataItems * whichRD.numBytes();
+        char *afPtr = dest + writePosition;
+        if(oldHeader) {
+            std::stringstream hss;
+            fio.write_header(hss, fab, fab.nComp());
+            hLength = static_cast<std::streamoff>(hss.tellp());
+            auto tstr = hss.str();
+            memcpy(afPtr, tstr.c_str(), hLength);  // ---- the fab header
+        }
+        if(doConvert) {
+            RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
+                                                    writeDataItems,
+                                                    fab.dataPtr(), whichRD);
+        } else {    // ---- copy from the fab
+            memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
+        }
+        writePosition += hLength + writeDataSize;
+    }
+}
+
+
 Long
 VisMF::WriteOnlyHeader (const FabArray<FArrayBox> & mf,
                         const std::string         & mf_name,
@@ -1262,6 +1537,52 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       const FABio &fio = FArrayBox::getFABio();
       int whichRDBytes(whichRD->numBytes());
       int nComps(mf.nComp());
+      bool compressed(hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1);
+
+#ifdef BL_USE_MPI
+      if(compressed) {   // ---- gather the compressed sizes
+        const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+        Vector<int> nmtags(nProcs,0);
+        Vector<int> offset(nProcs,0);
+
+        for(int i(0), N(mf.size()); i < N; ++i) {
+          nmtags[pmap[i]] += nComps;
+        }
+        for(int i(1), N(offset.size()); i < N; ++i) {
+          offset[i] = offset[i-1] + nmtags[i-1];
+        }
+
+        Vector<Long> senddata(std::max(nmtags[myProc], 1));
+        int ioffset(0);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+          for(int icomp(0); icomp < nComps; ++icomp) {
+            senddata[ioffset++] = hdr.m_csize[mfi.index()][icomp];
+          }
+        }
+
+        Vector<Long> recvdata(std::max(mf.size() * nComps, 1));
+
+        BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                    nmtags[myProc],
+                                    ParallelDescriptor::Mpi_typemap<Long>::type(),
+                                    recvdata.dataPtr(),
+                                    nmtags.dataPtr(),
+                                    offset.dataPtr(),
+                                    ParallelDescriptor::Mpi_typemap<Long>::type(),
+                                    coordinatorProc,
+                                    comm) );
+
+        if(myProc == coordinatorProc) {
+          Vector<int> cnt(nProcs,0);
+          for(int j(0), N(mf.size()); j < N; ++j) {
+            const int i(pmap[j]);
+            for(int icomp(0); icomp < nComps; ++icomp) {
+              hdr.m_csize[j][icomp] = recvdata[offset[i] + cnt[i]++];
+            }
+          }
+        }
+      }
+#endif
 
       if(myProc == coordinatorProc) {   // ---- calculate offsets
 	const BoxArray &mfBA = mf.boxArray();
@@ -1319,8 +1640,14 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 	      for(int i(0); i < index.size(); ++i) {
                  hdr.m_fod[index[i]].m_name = whichFileName;
                  hdr.m_fod[index[i]].m_head = currentOffset[whichFileNumber];
-                 currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
-	                                           + fabHeaderBytes[index[i]];
+                 if(compressed) {
+                   for(int icomp(0); icomp < nComps; ++icomp) {
+                     currentOffset[whichFileNumber] += hdr.m_csize[index[i]][icomp];
+                   }
+                 } else {
+                   currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+	                                             + fabHeaderBytes[index[i]];
+                 }
               }
             }
 	  }
@@ -1392,6 +1719,7 @@ VisMF::VisMF (const std::string &fafab_name)
 
 VisMF::~VisMF ()
 {
+    unmapFiles();
 }
 
 
@@ -1415,7 +1743,13 @@ VisMF::readFAB (int                  idx,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(hdr.m_vers == Header::Version_v1) {
+    if(hdr.m_vers == Header::NoFabHeaderCompressed_v1) {
+      if(whichComp == -1) {    // ---- read all components
+        VisMF::readCompressedFAB(*fab, 0, *infs, hdr, idx, 0, hdr.m_ncomp);
+      } else {
+        VisMF::readCompressedFAB(*fab, 0, *infs, hdr, idx, whichComp, 1);
+      }
+    } else if(hdr.m_vers == Header::Version_v1) {
       if(whichComp == -1) {    // ---- read all components
         fab->readFrom(*infs);
       } else {
@@ -1450,6 +1784,82 @@ VisMF::readFAB (int                  idx,
 }
 
 
+FArrayBox*
+VisMF::readFAB (int                  idx,
+                const std::string   &mf_name,
+                const VisMF::Header &hdr,
+                const Box           &region,
+                int                  comp,
+                int                  ncomp)
+{
+    BL_ASSERT(comp >= 0 && ncomp > 0 && comp + ncomp <= hdr.m_ncomp);
+
+    Box fab_box(hdr.m_ba[idx]);
+    if(hdr.m_ngrow.max() > 0) {
+        fab_box.grow(hdr.m_ngrow);
+    }
+    const Box bx(region & fab_box);
+    if( ! bx.ok()) {
+        amrex::Abort("VisMF::readFAB:  region does not intersect the fab");
+    }
+
+    FArrayBox *fab = new FArrayBox(bx, ncomp);
+
+    if(hdr.m_vers == Header::Version_v1) {
+      // ---- the format is only known after reading the fab header,
+      // ---- so read the whole components
+      for(int icomp(0); icomp < ncomp; ++icomp) {
+        std::unique_ptr<FArrayBox> src(VisMF::readFAB(idx, mf_name, hdr, comp + icomp));
+        fab->copy<RunOn::Host>(*src, bx, 0, bx, icomp, 1);
+      }
+      return fab;
+    }
+
+    std::string FullName(VisMF::DirName(mf_name));
+    FullName += hdr.m_fod[idx].m_name;
+
+    std::ifstream *infs = VisMF::OpenStream(FullName);
+    infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
+
+    if(hdr.m_vers == Header::NoFabHeaderCompressed_v1) {
+      // ---- a component can only be decompressed as a whole
+      FArrayBox src(fab_box, ncomp);
+      VisMF::readCompressedFAB(src, 0, *infs, hdr, idx, comp, ncomp);
+      fab->copy<RunOn::Host>(src, bx, 0, bx, 0, ncomp);
+    } else {
+      // ---- find the longest runs of cells that are contiguous in the file
+      const IntVect fablen(fab_box.length()), bxlen(bx.length());
+      Long runLength(bxlen[0]);
+      Box runStarts(bx);
+      runStarts.setBig(0, bx.smallEnd(0));
+      for(int idim(1); idim < AMREX_SPACEDIM && bxlen[idim-1] == fablen[idim-1]; ++idim) {
+        runLength *= bxlen[idim];
+        runStarts.setBig(idim, bx.smallEnd(idim));
+      }
+
+      const bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
+      const Long rdBytes(hdr.m_writtenRD.numBytes());
+      const Long fabPts(fab_box.numPts());
+      for(int icomp(0); icomp < ncomp; ++icomp) {
+        for(IntVect iv(runStarts.smallEnd()); iv <= runStarts.bigEnd(); runStarts.next(iv)) {
+          const Long pos(hdr.m_fod[idx].m_head + ((comp + icomp) * fabPts + fab_box.index(iv)) * rdBytes);
+          infs->seekg(pos, std::ios::beg);
+          Real *dst = fab->dataPtr(icomp) + bx.index(iv);
+          if(doConvert) {
+            RealDescriptor::convertToNativeFormat(dst, runLength, *infs, hdr.m_writtenRD);
+          } else {
+            infs->read((char *) dst, runLength * rdBytes);
+          }
+        }
+      }
+    }
+
+    VisMF::CloseStream(FullName);
+
+    return fab;
+}
+
+
 void
 VisMF::readFAB (FabArray<FArrayBox> &mf,
 		int                  idx,
@@ -1465,7 +1875,9 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(hdr.m_vers == Header::NoFabHeaderCompressed_v1) {
+      VisMF::readCompressedFAB(fab, 0, *infs, hdr, idx, 0, hdr.m_ncomp);
+    } else if(NoFabHeader(hdr)) {
       if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fab.dataPtr(), fab.nBytes());
       } else {
@@ -1481,6 +1893,49 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
 }
 
 
+void
+VisMF::readCompressedFAB (FArrayBox           &fab,
+                          int                  destComp,
+                          std::istream        &is,
+                          const VisMF::Header &hdr,
+                          int                  idx,
+                          int                  comp,
+                          int                  ncomp)
+{
+    const Vector<Long> &csize = hdr.m_csize[idx];
+    // ---- the components are stored one after another
+    Long skip(0);
+    for(int icomp(0); icomp < comp; ++icomp) {
+      skip += csize[icomp];
+    }
+    if(skip > 0) {
+      is.seekg(skip, std::ios::cur);
+    }
+
+    const Long npts(fab.box().numPts());
+    Vector<char> buffer;
+    for(int icomp(comp); icomp < comp + ncomp; ++icomp) {
+      buffer.resize(csize[icomp]);
+      is.read(buffer.dataPtr(), csize[icomp]);
+      if( ! is.good()) {
+        amrex::Error("VisMF::readCompressedFAB:  read failed");
+      }
+      FabCompress::Decompress(buffer.dataPtr(), csize[icomp],
+                              fab.dataPtr(destComp + icomp - comp), npts, hdr.m_writtenRD);
+    }
+}
+
+
+Real
+VisMF::CompressionTolerance (int comp)
+{
+    if(compressionTolerance.empty()) {
+      return 0.0;
+    }
+    return compressionTolerance[std::min<int>(comp, compressionTolerance.size() - 1)];
+}
+
+
 void
 VisMF::Read (FabArray<FArrayBox> &mf,
              const std::string   &mf_name,
@@ -1546,8 +2001,10 @@ VisMF::Read (FabArray<FArrayBox> &mf,
   int nOpensPerFile(nMFFileInStreams);
   int nProcs(ParallelDescriptor::NProcs());
   bool noFabHeader(NoFabHeader(hdr));
+  // ---- compressed fabs vary in size, so they are read individually
+  bool compressed(hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1);
 
-  if(noFabHeader && useSynchronousReads) {
+  if(noFabHeader && useSynchronousReads && ! compressed) {
 
     // ---- This code is only for reading in file order
     bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
@@ -1751,7 +2208,7 @@ VisMF::Read (FabArray<FArrayBox> &mf,
       faCopyTime = amrex::second() - faCopyTime;
     }
 
-  } else {    // ---- (noFabHeader && useSynchronousReads) == false
+  } else {    // ---- (noFabHeader && useSynchronousReads && ! compressed) == false
 
     int nReqs(0), ioProcNum(coordinatorProc);
     int nBoxes(hdr.m_ba.size());
@@ -2076,7 +2533,10 @@ void
 VisMF::clear (int fabIndex)
 {
     for(int ncomp(0), N(m_pa.size()); ncomp < N; ++ncomp) {
-        clear(ncomp, fabIndex);
+        clear(fabIndex, ncomp);
+    }
+    if(fabIndex < m_fab.size()) {
+        m_fab[fabIndex].reset();
     }
 }
 
@@ -2085,16 +2545,19 @@ VisMF::clear ()
 {
     for(int ncomp(0), N(m_pa.size()); ncomp < N; ++ncomp) {
         for(int fabIndex(0), M(m_pa[ncomp].size()); fabIndex < M; ++fabIndex) {
-            clear(ncomp, fabIndex);
+            clear(fabIndex, ncomp);
         }
     }
+    m_fab.clear();
+    unmapFiles();
 }
 
 
 bool VisMF::NoFabHeader(const VisMF::Header &hdr) {
-  if(hdr.m_vers == VisMF::Header::NoFabHeader_v1       ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+  if(hdr.m_vers == VisMF::Header::NoFabHeader_v1         ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
   {
     return true;
   }
@@ -2309,6 +2772,13 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
     }
 #endif
 
+    Long staged_bytes = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
+        staged_bytes += bx.numPts() * ncomp * sizeof(Real);
+    }
+    AsyncOut::Reserve(staged_bytes);
+
     auto myfabs = std::make_shared<Vector<FArrayBox> >();
     for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
         Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
@@ -2437,6 +2907,9 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
         ofs.close();
 
         AsyncOut::Notify();  // Notify others I am done
+
+        myfabs->clear();
+        AsyncOut::Release(staged_bytes);
     });
 }
 
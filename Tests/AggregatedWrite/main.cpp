@@ -0,0 +1,127 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_NFiles.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+    std::string readFile (std::string const& name)
+    {
+        std::ifstream ifs(name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    // Compare the header and the data files of two MultiFabs written with
+    // VisMF, on the I/O process.  The header records the names of the data
+    // files, so the MultiFabs have the same name in different directories.
+    bool sameFiles (std::string const& a, std::string const& b, int nfiles)
+    {
+        int same = true;
+        if (ParallelDescriptor::IOProcessor()) {
+            same = readFile(a+"_H") == readFile(b+"_H");
+            for (int i = 0; i < nfiles; ++i) {
+                const std::string fa = NFilesIter::FileName(i, a+"_D_");
+                const std::string fb = NFilesIter::FileName(i, b+"_D_");
+                same = same && (amrex::FileExists(fa) == amrex::FileExists(fb))
+                            && readFile(fa) == readFile(fb);
+            }
+        }
+        ParallelDescriptor::Bcast(&same, 1, ParallelDescriptor::IOProcessorNumber());
+        return same != 0;
+    }
+}
+
+// Write a MultiFab with static set selection, with and without
+// vismf.usesinglewrite, and with aggregated writes with several choices of
+// the aggregator, in small pieces, and check that the files are the same,
+// for each header version, including compressed data.
+void main_main ()
+{
+    int n_cell = 48;
+    int max_grid_size = 12;
+    int nfiles = 2;
+    Long buffer_size = 1000;
+    std::string mf_name = "mf_aggregated";
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nfiles", nfiles);
+        pp.query("buffer_size", buffer_size);
+        pp.query("mf_name", mf_name);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    MultiFab mf(ba, dm, 3, 1);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::ParallelFor(mfi.fabbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            a(i,j,k,0) = std::sin(0.1*i) + 0.5*j + k;
+            a(i,j,k,1) = 1.0;
+            a(i,j,k,2) = std::sin(12345.678*(i+3*j+7*k));
+        });
+    }
+
+    VisMF::SetNOutFiles(nfiles);
+    VisMF::SetAggregatorBufferSize(buffer_size);
+    const bool usedss = VisMF::GetUseDynamicSetSelection();
+    const bool usesinglewrite = VisMF::GetUseSingleWrite();
+    const std::string ref_name = "static/" + mf_name;
+    amrex::UtilCreateCleanDirectory("static");
+
+    Vector<VisMF::Header::Version> versions{VisMF::Header::Version_v1,
+                                            VisMF::Header::NoFabHeader_v1,
+                                            VisMF::Header::NoFabHeaderFAMinMax_v1,
+                                            VisMF::Header::NoFabHeaderCompressed_v1};
+    for (auto vers : versions) {
+        VisMF::SetHeaderVersion(vers);
+        for (auto fmt : {FABio::FAB_NATIVE, FABio::FAB_NATIVE_32}) {
+            FArrayBox::setFormat(fmt);
+            for (bool singlewrite : {false, true}) {
+                VisMF::SetUseAggregatedWrite(false);
+                VisMF::SetUseDynamicSetSelection(false);
+                VisMF::SetUseSingleWrite(singlewrite);
+                VisMF::Write(mf, ref_name);
+                for (int aggregator : {0, 1, -1}) {
+                    VisMF::SetUseAggregatedWrite(true);
+                    VisMF::SetAggregatorRank(aggregator);
+                    VisMF::Write(mf, mf_name);
+                    AMREX_ALWAYS_ASSERT(sameFiles(mf_name, ref_name, nfiles));
+                }
+            }
+            amrex::Print() << "Header version " << vers << ", "
+                           << (fmt == FABio::FAB_NATIVE ? "double" : "float")
+                           << ": aggregated files are the same\n";
+        }
+    }
+
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+    VisMF::SetUseAggregatedWrite(false);
+    VisMF::SetAggregatorRank(0);
+    VisMF::SetUseDynamicSetSelection(usedss);
+    VisMF::SetUseSingleWrite(usesinglewrite);
+}
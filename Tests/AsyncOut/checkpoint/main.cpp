@@ -0,0 +1,100 @@
+#include <AMReX.H>
+#include <AMReX_Particles.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// Write a particle checkpoint with amrex.async_out = 1 while the last
+// process's background thread is held up by an earlier job, and check that
+// the Header is not written before that process has written its particles.
+// Without MPI_THREAD_MULTIPLE, the checkpoint waits for the jobs of all
+// processes, so nothing is held up and the Header must exist when it returns.
+void main_main ()
+{
+    int n_cell = 32;
+    int max_grid_size = 8;
+    std::string check_file = "chk_async";
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("check_file", check_file);
+    }
+
+    AMREX_ALWAYS_ASSERT(AsyncOut::UseAsyncOut());
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, &rb, 0);
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    using PC = ParticleContainer<2,1,1,1>;
+    PC pc(geom, dm, ba);
+    PC::ParticleInitData pdata = {{1.0,2.0}, {3}, {4.0}, {5}};
+    pc.InitRandom(5000, 1234, pdata, false);
+
+    amrex::UtilCreateCleanDirectory(check_file, true);
+
+    const int nprocs = ParallelDescriptor::NProcs();
+#ifdef AMREX_MPI_THREAD_MULTIPLE
+    const bool hold = true;
+#else
+    const bool hold = nprocs == 1;
+#endif
+    const bool last = hold && ParallelDescriptor::MyProc() == nprocs-1;
+    auto go = std::make_shared<std::promise<void> >();
+    if (last) {
+        std::shared_future<void> ready = go->get_future().share();
+        AsyncOut::Submit([=] () { ready.wait(); });
+    }
+
+    pc.Checkpoint(check_file, "particles");
+
+    const std::string header = check_file + "/particles/Header";
+    if ( ! hold) {
+        ParallelDescriptor::Barrier();
+        AMREX_ALWAYS_ASSERT(amrex::FileExists(header));
+    }
+    else if (nprocs > 1) {
+        // Wait a little for this process's jobs, which include the Header
+        // job on the I/O process.  That job has to wait for the last one.
+        auto done = std::make_shared<std::promise<void> >();
+        std::future<void> done_f = done->get_future();
+        AsyncOut::Submit([=] () { done->set_value(); });
+        done_f.wait_for(std::chrono::seconds(1));
+        ParallelDescriptor::Barrier();
+        const bool early = amrex::FileExists(header);
+        amrex::Print() << "Header written before the last process's data: " << early << "\n";
+        AMREX_ALWAYS_ASSERT( ! early);
+        ParallelDescriptor::Barrier();
+    }
+    if (last) go->set_value();
+
+    AsyncOut::Finish();
+    ParallelDescriptor::Barrier();
+    AMREX_ALWAYS_ASSERT(amrex::FileExists(header));
+
+    PC pc2(geom, dm, ba);
+    pc2.Restart(check_file, "particles");
+    AMREX_ALWAYS_ASSERT(pc2.TotalNumberOfParticles() == pc.TotalNumberOfParticles());
+    amrex::Print() << "Restarted " << pc2.TotalNumberOfParticles() << " particles\n";
+}
@@ -0,0 +1,169 @@
+#include <AMReX.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <random>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+
+    using ISects = std::vector<std::pair<int,Box> >;
+
+    ISects sorted (ISects v)
+    {
+        std::sort(v.begin(), v.end(),
+                  [] (std::pair<int,Box> const& a, std::pair<int,Box> const& b)
+                  { return a.first < b.first; });
+        return v;
+    }
+
+    Long numPts (BoxList const& bl)
+    {
+        Long n = 0;
+        for (auto const& b : bl) n += b.numPts();
+        return n;
+    }
+
+    // Boxes of size max_grid_size, every other one chopped into boxes of 8.
+    BoxArray mixedBoxArray (Box const& domain, int max_grid_size, int every)
+    {
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        BoxList bl;
+        for (int i = 0; i < ba.size(); ++i) {
+            if (i % every == 0) {
+                BoxArray small(ba[i]);
+                small.maxSize(8);
+                for (int k = 0; k < small.size(); ++k) bl.push_back(small[k]);
+            } else {
+                bl.push_back(ba[i]);
+            }
+        }
+        return BoxArray(std::move(bl));
+    }
+}
+
+// Check that BoxArray::intersections, complementIn, intersects and
+// removeOverlap give the same results with the BVH as with the hash, for
+// BoxArrays of mixed box sizes in several index types and coarsenings.
+// Then time the intersections of every grown box with both indices.
+void main_main ()
+{
+    int nqueries = 2000;
+    Vector<int> timing_domain{AMREX_D_DECL(256,256,128)};
+    int timing_max_grid_size = 32;
+    {
+        ParmParse pp;
+        pp.query("nqueries", nqueries);
+        pp.queryarr("timing_domain", timing_domain, 0, AMREX_SPACEDIM);
+        pp.query("timing_max_grid_size", timing_max_grid_size);
+    }
+
+    std::mt19937 gen(7);
+    const BoxArray mixed = mixedBoxArray(Box(IntVect(0), IntVect(255)), 64, 3);
+    amrex::Print() << "Checking " << mixed.size() << " boxes\n";
+
+    bool same = true;
+    for (int variant = 0; variant < 4; ++variant)
+    {
+        // Separate BoxArrays so that each has its own index.
+        BoxArray a = mixed;
+        BoxArray b(mixed.boxList());
+        if (variant == 1) {
+            a.surroundingNodes();
+            b.surroundingNodes();
+        } else if (variant == 2) {
+            a.coarsen(IntVect(2));
+            b.coarsen(IntVect(2));
+        } else if (variant == 3) {
+            const IndexType xface(IntVect(AMREX_D_DECL(1,0,0)));
+            a.convert(xface);
+            a.coarsen(4);
+            b.convert(xface);
+            b.coarsen(4);
+        }
+
+        std::uniform_int_distribution<int> corner(-20, 260), length(0, 40);
+        bool variant_same = true;
+        for (int t = 0; t < nqueries; ++t)
+        {
+            IntVect lo(AMREX_D_DECL(corner(gen),corner(gen),corner(gen)));
+            IntVect hi = lo + IntVect(AMREX_D_DECL(length(gen),length(gen),length(gen)));
+            Box q(lo, hi, a.ixType());
+            const int ng = t % 3;
+
+            BoxArray::intersectionIndex(BoxArray::HASH);
+            auto ia = sorted(a.intersections(q, false, ng));
+            const Long ca = numPts(a.complementIn(q));
+            const bool xa = a.intersects(q);
+
+            BoxArray::intersectionIndex(BoxArray::BVH);
+            auto ib = sorted(b.intersections(q, false, ng));
+            const Long cb = numPts(b.complementIn(q));
+            const bool xb = b.intersects(q);
+
+            variant_same = variant_same && ia == ib && ca == cb && xa == xb;
+        }
+        amrex::Print() << "variant " << variant << ": BVH "
+                       << (variant_same ? "same as" : "DIFFERENT from") << " hash\n";
+        same = same && variant_same;
+    }
+
+    {
+        BoxList bl;
+        std::uniform_int_distribution<int> corner(0, 200), length(1, 60);
+        for (int t = 0; t < 300; ++t) {
+            IntVect lo(AMREX_D_DECL(corner(gen),corner(gen),corner(gen)));
+            bl.push_back(Box(lo, lo + IntVect(AMREX_D_DECL(length(gen),length(gen),length(gen)))));
+        }
+        BoxArray::intersectionIndex(BoxArray::HASH);
+        BoxArray r1(bl);
+        r1.removeOverlap();
+        BoxArray::intersectionIndex(BoxArray::BVH);
+        BoxArray r2(bl);
+        r2.removeOverlap();
+        BoxArray::intersectionIndex(BoxArray::HASH);
+        BoxArray c2(r2.boxList());
+        const bool ok = c2.isDisjoint() && r1.contains(c2) && c2.contains(r1);
+        amrex::Print() << "removeOverlap: BVH " << (ok ? "same as" : "DIFFERENT from") << " hash\n";
+        same = same && ok;
+    }
+
+    {
+        Box domain(IntVect(0), IntVect(timing_domain)-1);
+        const BoxList bl = mixedBoxArray(domain, timing_max_grid_size, 2).boxList();
+        for (auto idx : {BoxArray::HASH, BoxArray::BVH})
+        {
+            BoxArray::intersectionIndex(idx);
+            BoxArray x(bl);
+            const double t0 = amrex::second();
+            ISects isects;
+            Long n = 0;
+            for (int i = 0; i < x.size(); ++i) {
+                x.intersections(amrex::grow(x[i],2), isects);
+                n += isects.size();
+            }
+            amrex::Print() << (idx == BoxArray::HASH ? "HASH" : "BVH ") << ": "
+                           << x.size() << " boxes, " << n << " intersections in "
+                           << amrex::second()-t0 << " s\n";
+        }
+        BoxArray::intersectionIndex(BoxArray::HASH);
+    }
+
+    AMREX_ALWAYS_ASSERT(same);
+}
@@ -0,0 +1,86 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// FillBoundary and ParallelCopy with compressed messages must give
+// exactly the same results as without compression.
+void main_main ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    BoxArray ba2(domain);
+    ba2.maxSize(max_grid_size/2);
+    DistributionMapping dm2(ba2);
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, rb, 0, is_periodic);
+
+    // A smooth field, a constant one and a noisy one, so that some
+    // messages compress well and some are sent as is.
+    const int ncomp = 3;
+    MultiFab ref(ba, dm, ncomp, 1), cmp(ba, dm, ncomp, 1);
+    for (MFIter mfi(ref); mfi.isValid(); ++mfi) {
+        auto const& a = ref.array(mfi);
+        amrex::ParallelFor(mfi.validbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            a(i,j,k,0) = std::sin(0.1*i)*std::cos(0.05*j) + 0.01*k;
+            a(i,j,k,1) = 1.0;
+            a(i,j,k,2) = std::sin(12345.678*(i+3*j+7*k));
+        });
+    }
+    MultiFab::Copy(cmp, ref, 0, 0, ncomp, 0);
+    ref.setBndry(-1.0);
+    cmp.setBndry(-1.0);
+    cmp.setCommCompression(true);
+
+    ref.FillBoundary(geom.periodicity());
+    cmp.FillBoundary(geom.periodicity());
+
+    MultiFab ref2(ba2, dm2, ncomp, 1), cmp2(ba2, dm2, ncomp, 1);
+    ref2.setVal(0.0);
+    cmp2.setVal(0.0);
+    cmp2.setCommCompression(true);
+    ref2.ParallelCopy(ref, 0, 0, ncomp, 1, 1, geom.periodicity());
+    cmp2.ParallelCopy(cmp, 0, 0, ncomp, 1, 1, geom.periodicity());
+
+    Long nmsgs = FabArrayBase::m_CommComp_stats.nmsgs;
+    ParallelDescriptor::ReduceLongSum(nmsgs);
+    amrex::Print() << nmsgs << " compressed messages\n";
+    AMREX_ALWAYS_ASSERT(ParallelDescriptor::NProcs() == 1 || nmsgs > 0);
+
+    MultiFab::Subtract(cmp, ref, 0, 0, ncomp, 1);
+    MultiFab::Subtract(cmp2, ref2, 0, 0, ncomp, 1);
+    for (int n = 0; n < ncomp; ++n) {
+        const Real efb = cmp.norm0(n, 1);
+        const Real epc = cmp2.norm0(n, 1);
+        amrex::Print() << "component " << n << ": FillBoundary difference " << efb
+                       << ", ParallelCopy difference " << epc << "\n";
+        AMREX_ALWAYS_ASSERT(efb == 0.0 && epc == 0.0);
+    }
+}
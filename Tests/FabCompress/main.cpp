@@ -0,0 +1,159 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_FabCompress.H>
+#include <AMReX_FPC.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+
+    // A smooth field, a constant one, a field with a wide range of
+    // magnitudes and a noisy one, so that the codecs see runs, raw
+    // blocks and everything in between.
+    void fill (MultiFab& mf)
+    {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.array(mfi);
+            amrex::ParallelFor(mfi.fabbox(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                a(i,j,k,0) = std::sin(0.1*i)*std::cos(0.05*j) + 0.01*k;
+                a(i,j,k,1) = 1.0;
+                a(i,j,k,2) = std::exp(-0.001*(i*i+j*j+k*k)) * 1.e5;
+                a(i,j,k,3) = std::sin(12345.678*(i+3*j+7*k));
+            });
+        }
+    }
+
+    // Largest |a-b| - rel*|b| over the valid and ghost cells of component n.
+    Real maxError (MultiFab const& a, MultiFab const& b, int n, Real rel)
+    {
+        Real err = 0.0;
+        for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+            auto const& fa = a.const_array(mfi);
+            auto const& fb = b.const_array(mfi);
+            amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+            {
+                err = std::max(err, std::abs(fa(i,j,k,n)-fb(i,j,k,n))
+                                    - rel*std::abs(fb(i,j,k,n)));
+            });
+        }
+        ParallelDescriptor::ReduceRealMax(err);
+        return err;
+    }
+
+    void testCodec (const RealDescriptor& rd, Real rel, const std::string& name)
+    {
+        const int n = 4096;
+        Vector<Real> in(n);
+        for (int i = 0; i < n; ++i) {
+            in[i] = (i < n/2) ? std::sin(0.01*i) : std::sin(12345.678*i) * 1.e3;
+        }
+        in[7] = 0.0;
+        in[8] = -0.0;
+
+        for (Real tol : {Real(0.0), Real(1.e-6), Real(1.e-2)})
+        {
+            Vector<char> buf;
+            const Long nbytes = FabCompress::Compress(in.data(), n, rd, tol, buf);
+            AMREX_ALWAYS_ASSERT(nbytes == static_cast<Long>(buf.size()));
+            Vector<Real> out(n);
+            FabCompress::Decompress(buf.data(), nbytes, out.data(), n, rd);
+            Real err = 0.0;
+            for (int i = 0; i < n; ++i) {
+                err = std::max(err, std::abs(out[i]-in[i]) - tol - rel*std::abs(in[i]));
+            }
+            amrex::Print() << "FabCompress " << name << " tolerance " << tol
+                           << ": " << n*sizeof(Real) << " -> " << nbytes
+                           << " bytes, excess error " << err << "\n";
+            AMREX_ALWAYS_ASSERT(err <= 0.0);
+        }
+    }
+}
+
+void main_main ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    std::string file_prefix = "mf_compress";
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("file_prefix", file_prefix);
+    }
+
+    // Relative round-off of a conversion to 32-bit floats.
+    const Real rel32 = std::numeric_limits<float>::epsilon();
+    const Real rel64 = (sizeof(Real) == sizeof(float)) ? rel32 : 0.0;
+
+    // The codec by itself.
+    testCodec(FPC::NativeRealDescriptor(), rel64, "NATIVE");
+    testCodec(FPC::Native32RealDescriptor(), rel32, "NATIVE_32");
+    testCodec(FPC::Ieee32NormalRealDescriptor(), rel32, "IEEE_32");
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    const int ncomp = 4;
+
+    MultiFab mf(ba, dm, ncomp, 1);
+    fill(mf);
+
+    // VisMF::Header::NoFabHeaderCompressed_v1, lossless and with error
+    // bounds, in the native and 32-bit formats.
+    struct Case {
+        FABio::Format format;
+        std::string name;
+        Real rel;
+    };
+    const Vector<Case> cases{{FABio::FAB_NATIVE,    "NATIVE",    rel64},
+                             {FABio::FAB_NATIVE_32, "NATIVE_32", rel32},
+                             {FABio::FAB_IEEE_32,   "IEEE_32",   rel32}};
+    const Vector<Real> tolerance{1.e-6, 0.0, 1.e-3, 1.e-2};
+
+    VisMF::SetHeaderVersion(VisMF::Header::NoFabHeaderCompressed_v1);
+    for (auto const& c : cases)
+    {
+        FArrayBox::setFormat(c.format);
+        for (int lossy = 0; lossy <= 1; ++lossy)
+        {
+            if (lossy) {
+                VisMF::SetCompressionTolerance(tolerance);
+            } else {
+                VisMF::SetCompressionTolerance({});
+            }
+            const std::string name = file_prefix + "_" + c.name + (lossy ? "_lossy" : "");
+            VisMF::Write(mf, name);
+
+            MultiFab mfin(ba, dm, ncomp, 1);
+            VisMF::Read(mfin, name);
+            for (int n = 0; n < ncomp; ++n) {
+                const Real tol = lossy ? tolerance[n] : 0.0;
+                const Real err = maxError(mfin, mf, n, c.rel) - tol;
+                amrex::Print() << "VisMF " << name << ", component " << n
+                               << ": excess error " << err << "\n";
+                AMREX_ALWAYS_ASSERT(err <= 0.0);
+            }
+        }
+    }
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+    VisMF::SetCompressionTolerance({});
+}
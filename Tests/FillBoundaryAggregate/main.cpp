@@ -0,0 +1,88 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// Fill the ghost cells of MultiFabs with different BoxArrays, numbers of
+// components, ghost cells and index types, one at a time and with the
+// aggregated exchange, and check that the results are identical.
+void main_main ()
+{
+    int n_cell = 48;
+    int max_grid_size = 16;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    BoxArray ba2(domain);
+    ba2.maxSize(max_grid_size/2);
+    DistributionMapping dm(ba), dm2(ba2);
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, rb, 0, is_periodic);
+
+    Vector<std::unique_ptr<MultiFab>> ref, mfs;
+    ref.emplace_back(new MultiFab(ba,dm,3,2));
+    ref.emplace_back(new MultiFab(ba2,dm2,1,1));
+    ref.emplace_back(new MultiFab(amrex::convert(ba,IntVect::TheNodeVector()),dm,2,1));
+
+    for (auto& mf : ref) {
+        for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf->array(mfi);
+            amrex::ParallelFor((*mf)[mfi].box(), mf->nComp(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = -1.0;
+            });
+            amrex::ParallelFor(mfi.validbox(), mf->nComp(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = std::sin(0.1*i) + std::cos(0.2*j) + 0.3*k + n;
+            });
+        }
+    }
+
+    for (auto& mf : ref) {
+        mfs.emplace_back(new MultiFab(mf->boxArray(), mf->DistributionMap(),
+                                      mf->nComp(), mf->nGrowVect()));
+        MultiFab::Copy(*mfs.back(), *mf, 0, 0, mf->nComp(), mf->nGrowVect());
+        mf->FillBoundary(geom.periodicity());
+    }
+
+    Vector<MultiFab*> mfp{mfs[0].get(), mfs[1].get(), mfs[2].get()};
+    for (int aggregate = 0; aggregate <= 1; ++aggregate)
+    {
+        FabArrayBase::use_aggregated_fb = aggregate;
+        for (auto mf : mfp) {
+            mf->setBndry(-1.0);
+        }
+        amrex::FillBoundary(mfp, geom.periodicity());
+        for (int i = 0; i < mfp.size(); ++i) {
+            MultiFab diff(ref[i]->boxArray(), ref[i]->DistributionMap(),
+                          ref[i]->nComp(), ref[i]->nGrowVect());
+            MultiFab::Copy(diff, *mfp[i], 0, 0, diff.nComp(), diff.nGrowVect());
+            MultiFab::Subtract(diff, *ref[i], 0, 0, diff.nComp(), diff.nGrowVect());
+            const Real err = diff.norm0(0, diff.nGrowVect()[0]);
+            amrex::Print() << "use_aggregated_fb = " << aggregate << ", MultiFab " << i
+                           << ", max difference " << err << "\n";
+            AMREX_ALWAYS_ASSERT(err == 0.0);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+    int numMoved (DistributionMapping const& a, DistributionMapping const& b)
+    {
+        int n = 0;
+        for (int i = 0; i < a.size(); ++i) {
+            if (a[i] != b[i]) ++n;
+        }
+        return n;
+    }
+}
+
+// Rebalance a hot spot near a corner of the domain with makeKnapSack and
+// with makeIncremental, with and without a bound on the bytes moved, and
+// compare the efficiencies and the numbers of boxes moved.
+void main_main ()
+{
+    int n_cell = 128;
+    int max_grid_size = 16;
+    Real target_efficiency = 0.95;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("target_efficiency", target_efficiency);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    LayoutData<Real> cost(ba, dm), bytes(ba, dm);
+    Long total_bytes = 0;
+    for (MFIter mfi(cost); mfi.isValid(); ++mfi) {
+        const Box& b = mfi.validbox();
+        const IntVect& lo = b.smallEnd();
+        const Real r2 = AMREX_D_TERM(Real(lo[0])*lo[0], + Real(lo[1])*lo[1], + Real(lo[2])*lo[2]);
+        cost[mfi] = b.numPts() * (1.0 + 2.0*std::exp(-0.0005*r2));
+        bytes[mfi] = b.numPts() * sizeof(Real);
+        total_bytes += b.numPts() * sizeof(Real);
+    }
+    ParallelDescriptor::ReduceLongSum(total_bytes);
+
+    Real current_eff, proposed_eff;
+    auto knapsack = DistributionMapping::makeKnapSack(cost, current_eff, proposed_eff);
+    amrex::Print() << "makeKnapSack:    efficiency " << current_eff << " -> " << proposed_eff
+                   << ", moved " << numMoved(knapsack, dm) << " of " << ba.size() << " boxes\n";
+
+    // Without a bound, the target is reached for this case.  With a bound,
+    // the bound must be respected.
+    for (Long max_bytes : {Long(-1), total_bytes/50})
+    {
+        auto incr = DistributionMapping::makeIncremental(cost, bytes, current_eff, proposed_eff,
+                                                         target_efficiency, max_bytes);
+        Long moved_bytes = 0;
+        for (int i = 0; i < ba.size(); ++i) {
+            if (incr[i] != dm[i]) moved_bytes += ba[i].numPts() * sizeof(Real);
+        }
+        amrex::Print() << "makeIncremental: efficiency " << current_eff << " -> " << proposed_eff
+                       << ", moved " << numMoved(incr, dm) << " boxes, " << moved_bytes
+                       << " bytes (bound " << max_bytes << ")\n";
+        // The efficiencies are computed on the root process only.
+        if (ParallelDescriptor::IOProcessor()) {
+            AMREX_ALWAYS_ASSERT(proposed_eff >= current_eff);
+            AMREX_ALWAYS_ASSERT(max_bytes >= 0 || proposed_eff >= target_efficiency);
+        }
+        AMREX_ALWAYS_ASSERT(max_bytes < 0 || moved_bytes <= max_bytes);
+    }
+
+    // Nothing to do: the current mapping is returned.
+    auto same = DistributionMapping::makeIncremental(cost, bytes, current_eff, proposed_eff,
+                                                     0.0, -1);
+    AMREX_ALWAYS_ASSERT(DistributionMapping::SameRefs(same, dm));
+}
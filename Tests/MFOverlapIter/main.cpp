@@ -0,0 +1,96 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+    void laplacian (MultiFab& r, MultiFab const& a, Box const& bx, int K)
+    {
+        auto const& ra = r.array(K);
+        auto const& fa = a.const_array(K);
+        amrex::ParallelFor(bx,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            ra(i,j,k) = AMREX_D_TERM(fa(i-1,j,k) + fa(i+1,j,k),
+                                   + fa(i,j-1,k) + fa(i,j+1,k),
+                                   + fa(i,j,k-1) + fa(i,j,k+1))
+                - (2*AMREX_SPACEDIM)*fa(i,j,k);
+        });
+    }
+}
+
+// Apply a stencil while FillBoundary is in flight with MFOverlapIter, and
+// check that the result is identical to applying it after a blocking
+// FillBoundary, with both the default buffer type and float buffers.
+void main_main ()
+{
+    int n_cell = 48;
+    int max_grid_size = 16;
+    bool do_tiling = true;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("do_tiling", do_tiling);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, rb, 0, is_periodic);
+
+    MultiFab a(ba,dm,1,1), r_ref(ba,dm,1,0), r(ba,dm,1,0);
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        auto const& fa = a.array(mfi);
+        amrex::ParallelFor(mfi.validbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            fa(i,j,k) = std::sin(0.1*i) + std::cos(0.2*j) + 0.3*k + 1.e-9*i;
+        });
+    }
+
+    for (int use_float = 0; use_float <= 1; ++use_float)
+    {
+        a.setBndry(1.e30);
+        if (use_float) {
+            a.FillBoundary<float>(geom.periodicity());
+        } else {
+            a.FillBoundary(geom.periodicity());
+        }
+        for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+            laplacian(r_ref, a, mfi.validbox(), mfi.index());
+        }
+
+        a.setBndry(1.e30);
+        if (use_float) {
+            a.FillBoundary_nowait<float>(geom.periodicity());
+        } else {
+            a.FillBoundary_nowait(geom.periodicity());
+        }
+        r.setVal(1.e40);
+        for (MFOverlapIter mfi(a, do_tiling); mfi.isValid(); ++mfi) {
+            laplacian(r, a, mfi.tilebox(), mfi.index());
+        }
+
+        MultiFab::Subtract(r, r_ref, 0, 0, 1, 0);
+        const Real err = r.norm0();
+        amrex::Print() << "float buffers = " << use_float
+                       << ", max difference " << err << "\n";
+        AMREX_ALWAYS_ASSERT(err == 0.0);
+    }
+}
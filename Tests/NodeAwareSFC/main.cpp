@@ -0,0 +1,90 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// Map a shell of boxes with the LayoutData version of makeSFC, which does
+// the mapping on one rank only, with each rank as the root.  With
+// DistributionMapping.node_aware = 1 this must not hang, and must agree
+// with the mapping done on all ranks.
+void main_main ()
+{
+    int n_cell = 128;
+    int max_grid_size = 8;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    BoxList bl;
+    {
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        const Real c = 0.5*n_cell;
+        for (int i = 0; i < ba.size(); ++i) {
+            const Box& b = ba[i];
+            Real r2 = 0;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                Real x = 0.5*(b.smallEnd(idim)+b.bigEnd(idim)+1) - c;
+                r2 += x*x;
+            }
+            const Real r = std::sqrt(r2);
+            if (r > 0.25*n_cell && r < 0.45*n_cell) bl.push_back(b);
+        }
+    }
+    BoxArray ba(bl);
+    const int nprocs = ParallelDescriptor::NProcs();
+    Vector<int> pmap(ba.size());
+    for (int i = 0; i < ba.size(); ++i) {
+        pmap[i] = i % nprocs;
+    }
+    DistributionMapping dm(std::move(pmap));
+
+    Vector<Real> rcost(ba.size());
+    for (int i = 0; i < ba.size(); ++i) {
+        rcost[i] = ba[i].numPts() * (1.0 + (i%7)*0.1);
+    }
+    LayoutData<Real> cost(ba, dm);
+    for (MFIter mfi(cost); mfi.isValid(); ++mfi) {
+        cost[mfi] = rcost[mfi.index()];
+    }
+
+    Vector<DistributionMapping> dm_root(nprocs);
+    Vector<Real> eff_root(nprocs);
+    for (int root = 0; root < nprocs; ++root)
+    {
+        Real current_eff;
+        dm_root[root] = DistributionMapping::makeSFC(cost, current_eff, eff_root[root],
+                                                     true, root);
+    }
+
+    Real eff;
+    DistributionMapping dm_all = DistributionMapping::makeSFC(rcost, ba, eff, false);
+
+    for (int root = 0; root < nprocs; ++root)
+    {
+        AMREX_ALWAYS_ASSERT(dm_root[root] == dm_all);
+        if (ParallelDescriptor::MyProc() == root) {
+            AMREX_ALWAYS_ASSERT(std::abs(eff_root[root]-eff) < 1.e-12);
+        }
+    }
+
+    amrex::Print() << ba.size() << " boxes on " << nprocs << " ranks, SFC efficiency "
+                   << eff << "\n";
+}
@@ -0,0 +1,173 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+
+    using CopyComTag = FabArrayBase::CopyComTag;
+    using CommMetaData = FabArrayBase::CommMetaData;
+
+    bool sameTag (const CopyComTag& a, const CopyComTag& b)
+    {
+        return a.dbox == b.dbox && a.sbox == b.sbox
+            && a.dstIndex == b.dstIndex && a.srcIndex == b.srcIndex;
+    }
+
+    bool sameTags (const FabArrayBase::CopyComTagsContainer& a,
+                   const FabArrayBase::CopyComTagsContainer& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), sameTag);
+    }
+
+    // The local copies may be in any order, the send and recv tags must be
+    // in the same order.
+    bool sameMetaData (const CommMetaData& a, const CommMetaData& b)
+    {
+        auto la = *a.m_LocTags;
+        auto lb = *b.m_LocTags;
+        auto less = [] (const CopyComTag& x, const CopyComTag& y) {
+            return x < y || (!(y < x) && x.dbox.smallEnd() < y.dbox.smallEnd());
+        };
+        std::sort(la.begin(), la.end(), less);
+        std::sort(lb.begin(), lb.end(), less);
+        bool same = sameTags(la, lb)
+            && a.m_threadsafe_loc == b.m_threadsafe_loc
+            && a.m_threadsafe_rcv == b.m_threadsafe_rcv
+            && a.m_SndTags->size() == b.m_SndTags->size()
+            && a.m_RcvTags->size() == b.m_RcvTags->size();
+        for (int ipass = 0; ipass < 2 && same; ++ipass)
+        {
+            auto const& ma = (ipass == 0) ? *a.m_SndTags : *a.m_RcvTags;
+            auto const& mb = (ipass == 0) ? *b.m_SndTags : *b.m_RcvTags;
+            for (auto const& kv : ma) {
+                auto it = mb.find(kv.first);
+                same = same && it != mb.end() && sameTags(kv.second, it->second);
+            }
+        }
+        return same;
+    }
+
+    CommMetaData copyMetaData (const CommMetaData& a)
+    {
+        CommMetaData r;
+        r.m_threadsafe_loc = a.m_threadsafe_loc;
+        r.m_threadsafe_rcv = a.m_threadsafe_rcv;
+        r.m_LocTags.reset(new FabArrayBase::CopyComTagsContainer(*a.m_LocTags));
+        r.m_SndTags.reset(new FabArrayBase::MapOfCopyComTagContainers(*a.m_SndTags));
+        r.m_RcvTags.reset(new FabArrayBase::MapOfCopyComTagContainers(*a.m_RcvTags));
+        return r;
+    }
+}
+
+// Change a few boxes of a BoxArray and their owners, as a small regrid
+// would, and check that the FillBoundary and ParallelCopy metadata built
+// by patchCommMetaData from those of the old BoxArray are the same as the
+// metadata built from scratch.
+void main_main ()
+{
+    int n_cell = 48;
+    int max_grid_size = 8;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const IntVect ng(2);
+
+    bool all_same = true;
+    for (int periodic = 0; periodic <= 1; ++periodic) {
+    for (int nodal = 0; nodal <= 1; ++nodal)
+    {
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(periodic,periodic,periodic)};
+        Geometry geom(domain, rb, 0, is_periodic);
+        const Periodicity& period = geom.periodicity();
+
+        BoxArray old_ba(domain);
+        old_ba.maxSize(max_grid_size);
+        DistributionMapping old_dm(old_ba);
+
+        // Split a few boxes and move a few others to another process.
+        const int nboxes = old_ba.size();
+        BoxList bl;
+        Vector<int> pmap;
+        for (int i = 0; i < nboxes; ++i) {
+            if (i == nboxes/10 || i == nboxes/3) {
+                Box lo = old_ba[i];
+                Box hi = lo.chop(0, lo.smallEnd(0)+max_grid_size/2);
+                bl.push_back(lo);
+                pmap.push_back(old_dm[i]);
+                bl.push_back(hi);
+                pmap.push_back((old_dm[i]+1) % nprocs);
+            } else if (i == nboxes/5 || i == nboxes-1) {
+                bl.push_back(old_ba[i]);
+                pmap.push_back((old_dm[i]+1) % nprocs);
+            } else {
+                bl.push_back(old_ba[i]);
+                pmap.push_back(old_dm[i]);
+            }
+        }
+        BoxArray new_ba(std::move(bl));
+        DistributionMapping new_dm(pmap);
+        if (nodal) {
+            old_ba.surroundingNodes();
+            new_ba.surroundingNodes();
+        }
+
+        BoxArray other_ba = old_ba;
+        other_ba.maxSize(2*max_grid_size);
+        DistributionMapping other_dm(other_ba);
+
+        MultiFab other(other_ba, other_dm, 1, 1);
+        MultiFab old_mf(old_ba, old_dm, 1, ng);
+        old_mf.getFB(ng, period);
+        old_mf.getCPC(ng, other, IntVect(1), period);
+        other.getCPC(IntVect(1), old_mf, ng, period);
+        old_mf.getCPC(IntVect(0), old_mf, IntVect(1), period);
+
+        MultiFab new_mf(new_ba, new_dm, 1, ng);
+        const Long npatch = FabArrayBase::m_FBC_stats.npatch + FabArrayBase::m_CPC_stats.npatch;
+        new_mf.patchCommMetaData(old_mf);
+        const Long npatched = FabArrayBase::m_FBC_stats.npatch
+            + FabArrayBase::m_CPC_stats.npatch - npatch;
+
+        auto fb   = copyMetaData(new_mf.getFB(ng, period));
+        auto cpc1 = copyMetaData(new_mf.getCPC(ng, other, IntVect(1), period));
+        auto cpc2 = copyMetaData(other.getCPC(IntVect(1), new_mf, ng, period));
+        auto cpc3 = copyMetaData(new_mf.getCPC(IntVect(0), new_mf, IntVect(1), period));
+
+        new_mf.flushFB();
+        new_mf.flushCPC();
+
+        int same = sameMetaData(fb,   new_mf.getFB(ng, period))
+            &&     sameMetaData(cpc1, new_mf.getCPC(ng, other, IntVect(1), period))
+            &&     sameMetaData(cpc2, other.getCPC(IntVect(1), new_mf, ng, period))
+            &&     sameMetaData(cpc3, new_mf.getCPC(IntVect(0), new_mf, IntVect(1), period));
+        ParallelDescriptor::ReduceIntMin(same);
+
+        amrex::Print() << "periodic " << periodic << ", nodal " << nodal << ": "
+                       << npatched << " items patched, "
+                       << (same ? "same as" : "DIFFERENT from") << " a fresh build\n";
+        all_same = all_same && same && npatched == 4;
+    }}
+
+    AMREX_ALWAYS_ASSERT(all_same);
+}
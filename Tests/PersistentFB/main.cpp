@@ -0,0 +1,110 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// Fill the ghost cells of MultiFabs on several BoxArrays with the
+// communication options given in the inputs (e.g., fabarray.use_persistent_fb
+// and fabarray.use_shmem_fb), and compare with the default FillBoundary.
+// The cached metadata of all the BoxArrays are flushed together, which
+// frees their MPI resources collectively, both in the middle of the run
+// and in amrex::Finalize.  The bytes of the cache, including the
+// persistent plans, are checked against the cache statistics.
+void main_main ()
+{
+    int n_cell = 32;
+    int nboxarrays = 8;
+    int niters = 4;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("nboxarrays", nboxarrays);
+        pp.query("niters", niters);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, rb, 0, is_periodic);
+
+    const bool use_persistent_fb = FabArrayBase::use_persistent_fb;
+    const bool use_shmem_fb = FabArrayBase::use_shmem_fb;
+    const bool use_neighbor_fb = FabArrayBase::use_neighbor_fb;
+
+    Vector<std::unique_ptr<MultiFab> > mfs;
+    for (int i = 0; i < nboxarrays; ++i) {
+        BoxArray ba(domain);
+        ba.maxSize(n_cell/2 - 2*(i%4));
+        DistributionMapping dm(ba);
+        mfs.emplace_back(new MultiFab(ba, dm, 1+i%3, 1+i%2));
+    }
+
+    Real err = 0.0;
+    for (int iter = 0; iter < niters; ++iter)
+    {
+        for (auto& mf : mfs)
+        {
+            const int ncomp = mf->nComp();
+            const int ngrow = mf->nGrow();
+            MultiFab ref(mf->boxArray(), mf->DistributionMap(), ncomp, ngrow);
+            for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+                auto const& a = mf->array(mfi);
+                amrex::ParallelFor(mfi.validbox(), ncomp,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    a(i,j,k,n) = std::sin(0.1*i+iter) + std::cos(0.2*j) + 0.3*k + n;
+                });
+            }
+            MultiFab::Copy(ref, *mf, 0, 0, ncomp, 0);
+            mf->setBndry(-1.0);
+            ref.setBndry(-2.0);
+
+            mf->FillBoundary(geom.periodicity());
+
+            FabArrayBase::use_persistent_fb = false;
+            FabArrayBase::use_shmem_fb = false;
+            FabArrayBase::use_neighbor_fb = false;
+            ref.FillBoundary(geom.periodicity());
+            FabArrayBase::use_persistent_fb = use_persistent_fb;
+            FabArrayBase::use_shmem_fb = use_shmem_fb;
+            FabArrayBase::use_neighbor_fb = use_neighbor_fb;
+
+            MultiFab::Subtract(ref, *mf, 0, 0, ncomp, ngrow);
+            err = std::max(err, ref.norm0(0, ngrow));
+        }
+
+        if (iter == niters/2) {
+            FabArrayBase::flushFBCache();
+        }
+    }
+
+    amrex::Print() << "max difference " << err << "\n";
+    AMREX_ALWAYS_ASSERT(err == 0.0);
+
+    // The cache byte count includes the persistent plans.
+    Long bytes = 0, plan_bytes = 0;
+    for (auto const& kv : FabArrayBase::m_TheFBCache) {
+        bytes += kv.second->bytes();
+        plan_bytes += kv.second->planBytes();
+    }
+    amrex::Print() << "FB cache bytes " << bytes << ", of which persistent plans "
+                   << plan_bytes << "\n";
+    AMREX_ALWAYS_ASSERT(bytes == FabArrayBase::m_FBC_stats.bytes &&
+                        plan_bytes == FabArrayBase::m_FBC_stats.plan_bytes);
+    AMREX_ALWAYS_ASSERT(!use_persistent_fb || ParallelDescriptor::NProcs() == 1 ||
+                        plan_bytes > 0);
+}
@@ -0,0 +1,106 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+// Write a plotfile with each header version that has a reader for sub-boxes
+// (Version_v1, NoFabHeader_v1 and NoFabHeaderCompressed_v1), in double and
+// single precision, and check that PlotFileData::get(level, region, icomp,
+// ncomp) returns the same values as the same part of get(level), with and
+// without vismf.usemmap.
+void main_main ()
+{
+    int n_cell = 64;
+    int max_grid_size = 16;
+    std::string plot_file = "plt_subregion";
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("plot_file", plot_file);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    const int ncomp = 3;
+    MultiFab mf(ba, dm, ncomp, 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::ParallelFor(mfi.fabbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            a(i,j,k,0) = i + 100*j + 10000*k;
+            a(i,j,k,1) = std::sin(0.1*i) * std::cos(0.2*j) + 0.01*k;
+            a(i,j,k,2) = std::exp(-0.001*(i*i+j*j+k*k));
+        });
+    }
+
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, &rb, 0);
+
+    // A thin slab across many boxes, a small box inside one box, and a box
+    // sticking out of the domain.
+    const IntVect lo(0), hi(n_cell-1), mid(n_cell/2);
+    Vector<Box> regions{Box(IntVect(AMREX_D_DECL(lo[0]+5, mid[1], lo[2])),
+                            IntVect(AMREX_D_DECL(hi[0]-5, mid[1], hi[2]))),
+                        Box(IntVect(1), IntVect(3)),
+                        Box(mid, hi+IntVect(8))};
+
+    const bool usemmap = VisMF::GetUseMMap();
+    Vector<VisMF::Header::Version> versions{VisMF::Header::Version_v1,
+                                            VisMF::Header::NoFabHeader_v1,
+                                            VisMF::Header::NoFabHeaderCompressed_v1};
+
+    for (auto vers : versions) {
+        for (auto fmt : {FABio::FAB_NATIVE, FABio::FAB_NATIVE_32}) {
+            VisMF::SetHeaderVersion(vers);
+            FArrayBox::setFormat(fmt);
+            WriteSingleLevelPlotfile(plot_file, mf, {"a", "b", "c"}, geom, 0.0, 0);
+            FArrayBox::setFormat(FABio::FAB_NATIVE);
+            ParallelDescriptor::Barrier();
+
+            for (bool mmap : {false, true}) {
+                VisMF::SetUseMMap(mmap);
+                PlotFileData pf(plot_file);
+                const MultiFab full = pf.get(0);
+                for (Box const& region : regions) {
+                    for (int icomp = 0; icomp < ncomp; ++icomp) {
+                        const int nc = ncomp-icomp;
+                        MultiFab sub = pf.get(0, region, icomp, nc);
+                        AMREX_ALWAYS_ASSERT(sub.boxArray().numPts() == (region & domain).numPts());
+
+                        MultiFab ref(sub.boxArray(), sub.DistributionMap(), nc, 0);
+                        ref.ParallelCopy(full, icomp, 0, nc);
+                        MultiFab::Subtract(ref, sub, 0, 0, nc, 0);
+                        for (int n = 0; n < nc; ++n) {
+                            AMREX_ALWAYS_ASSERT(ref.norm0(n) == 0.0);
+                        }
+                    }
+                }
+            }
+            amrex::Print() << "Header version " << vers << ", "
+                           << (fmt == FABio::FAB_NATIVE ? "double" : "float")
+                           << ": sub-boxes agree\n";
+        }
+    }
+    VisMF::SetUseMMap(usemmap);
+}
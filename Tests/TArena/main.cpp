@@ -0,0 +1,120 @@
+#include <AMReX.H>
+#include <AMReX_TArena.H>
+#include <AMReX_Print.H>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace amrex;
+
+void main_main ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    main_main();
+
+    amrex::Finalize();
+}
+
+namespace {
+    // Allocate and free blocks of random sizes up to max_bytes, keeping at
+    // most nlive of them, and check that they are not overwritten.
+    int churn (TArena& a, int seed, int n, std::size_t max_bytes, std::size_t nlive)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::pair<char*,std::size_t> > live;
+        int nbad = 0;
+        for (int i = 0; i < n; ++i) {
+            const std::size_t nbytes = 1 + rng() % max_bytes;
+            char* p = static_cast<char*>(a.alloc(nbytes));
+            p[0] = p[nbytes-1] = static_cast<char>(seed);
+            live.emplace_back(p, nbytes);
+            if (live.size() > nlive) {
+                const std::size_t k = rng() % live.size();
+                auto q = live[k];
+                if (q.first[0] != static_cast<char>(seed) ||
+                    q.first[q.second-1] != static_cast<char>(seed)) {
+                    ++nbad;
+                }
+                a.free(q.first);
+                live[k] = live.back();
+                live.pop_back();
+            }
+        }
+        for (auto const& q : live) {
+            a.free(q.first);
+        }
+        return nbad;
+    }
+}
+
+// Check that TArena returns free slabs to the system, both on demand with
+// release() and when the free memory outside the thread caches exceeds the
+// release threshold.
+void main_main ()
+{
+    const std::size_t MB = 1024*1024;
+
+    {
+        TArena a(0, ArenaInfo(), 0);
+        AMREX_ALWAYS_ASSERT(churn(a, 1, 100000, 64*1024, 2000) == 0);
+        const std::size_t used = a.heap_space_used();
+        const std::size_t released = a.release();
+        amrex::Print() << "release(): " << used/MB << " MB held, "
+                       << released/MB << " MB released\n";
+        AMREX_ALWAYS_ASSERT(a.heap_space_used() == 0);
+        AMREX_ALWAYS_ASSERT(released == used);
+        AMREX_ALWAYS_ASSERT(a.heap_space_actually_used() == 0);
+    }
+
+    {
+        // Free a lot of memory in the order it was allocated.  What is kept
+        // is bounded by the thread cache (16 MB), the free blocks below the
+        // threshold, and the slabs they keep from being released.
+        const std::size_t threshold = 8*MB;
+        TArena a(0, ArenaInfo(), threshold);
+        std::mt19937 rng(2);
+        std::vector<void*> blocks;
+        std::size_t total = 0;
+        while (total < 256*MB) {
+            const std::size_t nbytes = 1 + rng() % (16*1024);
+            blocks.push_back(a.alloc(nbytes));
+            total += nbytes;
+        }
+        const std::size_t peak = a.heap_space_used();
+        for (void* p : blocks) {
+            a.free(p);
+        }
+        const std::size_t used = a.heap_space_used();
+        amrex::Print() << "threshold " << threshold/MB << " MB: " << peak/MB << " MB at the peak, "
+                       << used/MB << " MB held after the frees\n";
+        AMREX_ALWAYS_ASSERT(used < 48*MB);
+    }
+
+    {
+        // Threads that call release() when they are done give everything
+        // back between them.
+        const int nthreads = 4;
+        TArena a;
+        std::vector<std::thread> threads;
+        std::vector<int> nbad(nthreads, 0);
+        for (int t = 0; t < nthreads; ++t) {
+            threads.emplace_back([&a, &nbad, t] () {
+                nbad[t] = churn(a, 10+t, 50000, 16*1024, 5000);
+                a.release();
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        for (int t = 0; t < nthreads; ++t) {
+            AMREX_ALWAYS_ASSERT(nbad[t] == 0);
+        }
+        amrex::Print() << nthreads << " threads: " << a.heap_space_used()/MB
+                       << " MB held after release()\n";
+        AMREX_ALWAYS_ASSERT(a.heap_space_used() == 0);
+    }
+}
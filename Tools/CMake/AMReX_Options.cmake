@@ -95,6 +95,10 @@ print_option( DIM )
 option( ENABLE_MPI  "Enable MPI"  ON)
 print_option( ENABLE_MPI )
 
+cmake_dependent_option( ENABLE_MPI3 "Enable MPI-3 shared memory features" OFF
+   "ENABLE_MPI" OFF )
+print_option( ENABLE_MPI3 )
+
 option( ENABLE_OMP  "Enable OpenMP" OFF)
 print_option( ENABLE_OMP )
 
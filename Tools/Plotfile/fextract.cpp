@@ -178,12 +178,16 @@ void main_main()
             const iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
                                                 pf.boxArray(ilev+1), ratio);
             for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const int icomp = std::distance(var_names_pf.begin(),
+                                                std::find(var_names_pf.begin(), var_names_pf.end(),
+                                                          var_names[ivar]));
+                for (MFIter mfi(mask); mfi.isValid(); ++mfi) {
                     const Box& bx = mfi.validbox() & slice_box;
                     if (bx.ok()) {
                         const auto& m = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
+                        // only read the cells on the slice
+                        const FArrayBox slice = pf.getFab(ilev, mfi.index(), bx, icomp, 1);
+                        const auto& fab = slice.const_array();
                         const auto lo = amrex::lbound(bx);
                         const auto hi = amrex::ubound(bx);
                         for         (int k = lo.z; k <= hi.z; ++k) {
@@ -208,11 +212,14 @@ void main_main()
             rr *= ratio;
         } else {
             for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const int icomp = std::distance(var_names_pf.begin(),
+                                                std::find(var_names_pf.begin(), var_names_pf.end(),
+                                                          var_names[ivar]));
+                for (MFIter mfi(pf.boxArray(ilev), pf.DistributionMap(ilev)); mfi.isValid(); ++mfi) {
                     const Box& bx = mfi.validbox() & slice_box;
                     if (bx.ok()) {
-                        const auto& fab = mf.array(mfi);
+                        const FArrayBox slice = pf.getFab(ilev, mfi.index(), bx, icomp, 1);
+                        const auto& fab = slice.const_array();
                         const auto lo = amrex::lbound(bx);
                         const auto hi = amrex::ubound(bx);
                         for         (int k = lo.z; k <= hi.z; ++k) {